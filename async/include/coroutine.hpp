@@ -0,0 +1,657 @@
+#pragma once
+
+#if __cplusplus < 202002L || !defined(__cpp_impl_coroutine)
+#error "coroutine.hpp needs C++20 coroutines"
+#endif
+
+#include <async/include/thread_pool.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace regit::async {
+
+namespace detail
+{
+  // suspends the coroutine and resumes it from a task posted to the pool. If the pool is
+  // stopped before that task runs the coroutine is never resumed (nor destroyed)
+  template <typename PoolT>
+  class ScheduleAwaitable
+  {
+  public:
+    explicit ScheduleAwaitable(PoolT& pool) noexcept
+      : m_pool{pool}
+    {
+    }
+
+    bool await_ready() const noexcept
+    {
+      return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> coroutine)
+    {
+      m_pool.Post([coroutine] { coroutine.resume(); });
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+
+  private:
+    PoolT& m_pool;
+  };
+
+} // detail namespace
+
+namespace coro
+{
+  template <typename T = void>
+  class Task;
+
+namespace detail
+{
+  struct FreeFrame
+  {
+    FreeFrame* m_next;
+  };
+
+  struct FrameCache
+  {
+    static constexpr size_t GRANULE = 64;
+    static constexpr size_t CLASSES = 16;
+    // per size class, so a burst of frees does not pin memory forever
+    static constexpr size_t MAX_CACHED = 256;
+
+    FrameCache() = default;
+    FrameCache(const FrameCache&) = delete;
+    FrameCache& operator=(const FrameCache&) = delete;
+
+    ~FrameCache()
+    {
+      for (FreeFrame* head : m_heads)
+        while (head)
+          ::operator delete(std::exchange(head, head->m_next));
+    }
+
+    FreeFrame* m_heads[CLASSES] = {};
+    size_t m_sizes[CLASSES] = {};
+  };
+
+  // Coroutine frames come in a handful of sizes and are allocated and freed at a high rate,
+  // so frames up to GRANULE * CLASSES bytes are recycled through per thread free lists by
+  // size class. A frame freed on another thread than it was allocated on simply moves over
+  // to that thread's cache; larger frames go straight to operator new.
+  class FrameAllocator final
+  {
+  public:
+    static void* Allocate(size_t size)
+    {
+      const size_t index = SizeClass(size);
+      if (index >= FrameCache::CLASSES)
+        return ::operator new(size);
+
+      if (FreeFrame* frame = s_cache.m_heads[index])
+      {
+        s_cache.m_heads[index] = frame->m_next;
+        --s_cache.m_sizes[index];
+        return frame;
+      }
+      return ::operator new((index + 1) * FrameCache::GRANULE);
+    }
+
+    static void Deallocate(void* frame, size_t size) noexcept
+    {
+      const size_t index = SizeClass(size);
+      if (index >= FrameCache::CLASSES || s_cache.m_sizes[index] == FrameCache::MAX_CACHED)
+      {
+        ::operator delete(frame);
+        return;
+      }
+
+      s_cache.m_heads[index] = ::new (frame) FreeFrame{s_cache.m_heads[index]};
+      ++s_cache.m_sizes[index];
+    }
+
+  private:
+    static size_t SizeClass(size_t size) noexcept
+    {
+      return size ? (size - 1) / FrameCache::GRANULE : 0;
+    }
+
+    static inline thread_local FrameCache s_cache;
+  };
+
+  class PromiseBase
+  {
+  public:
+    // resumes whoever awaited the task, by symmetric transfer so long chains of tasks that
+    // complete synchronously do not grow the stack
+    struct FinalAwaiter
+    {
+      bool await_ready() const noexcept
+      {
+        return false;
+      }
+
+      template <typename PromiseT>
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<PromiseT> coroutine) noexcept
+      {
+        std::coroutine_handle<> continuation = coroutine.promise().m_continuation;
+        return continuation ? continuation : std::noop_coroutine();
+      }
+
+      void await_resume() const noexcept
+      {
+      }
+    };
+
+    // lazy, nothing runs until the task is awaited
+    std::suspend_always initial_suspend() const noexcept
+    {
+      return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept
+    {
+      return {};
+    }
+
+    void SetContinuation(std::coroutine_handle<> continuation) noexcept
+    {
+      m_continuation = continuation;
+    }
+
+    static void* operator new(size_t size)
+    {
+      return FrameAllocator::Allocate(size);
+    }
+
+    static void operator delete(void* frame, size_t size) noexcept
+    {
+      FrameAllocator::Deallocate(frame, size);
+    }
+
+  private:
+    std::coroutine_handle<> m_continuation;
+  };
+
+  template <typename T>
+  class Promise final : public PromiseBase
+  {
+  public:
+    Task<T> get_return_object() noexcept;
+
+    template <typename ValueT, std::enable_if_t<std::is_convertible_v<ValueT&&, T>, int> = 0>
+    void return_value(ValueT&& value)
+    {
+      m_result.template emplace<1>(std::forward<ValueT>(value));
+    }
+
+    void unhandled_exception() noexcept
+    {
+      m_result.template emplace<2>(std::current_exception());
+    }
+
+    T Result()
+    {
+      if (m_result.index() == 2)
+        std::rethrow_exception(std::get<2>(m_result));
+      return std::move(std::get<1>(m_result));
+    }
+
+  private:
+    std::variant<std::monostate, T, std::exception_ptr> m_result;
+  };
+
+  template <>
+  class Promise<void> final : public PromiseBase
+  {
+  public:
+    Task<void> get_return_object() noexcept;
+
+    void return_void() const noexcept
+    {
+    }
+
+    void unhandled_exception() noexcept
+    {
+      m_exception = std::current_exception();
+    }
+
+    void Result()
+    {
+      if (m_exception)
+        std::rethrow_exception(m_exception);
+    }
+
+  private:
+    std::exception_ptr m_exception;
+  };
+
+  // lets the helpers below wait for a task without taking its result
+  struct TaskAccess
+  {
+    template <typename T>
+    static std::coroutine_handle<Promise<T>> Handle(const Task<T>& task) noexcept
+    {
+      return task.m_handle;
+    }
+  };
+
+  // a default constructed or moved from Task has no coroutine that could produce a result
+  inline void ExpectTask(bool valid)
+  {
+    if (!valid)
+      throw std::logic_error{"awaiting an empty task!"};
+  }
+
+  // starts the task and resumes the awaiter once it finished, the result stays in the task
+  template <typename T>
+  class ReadyAwaiter
+  {
+  public:
+    explicit ReadyAwaiter(std::coroutine_handle<Promise<T>> task) noexcept
+      : m_task{task}
+    {
+    }
+
+    bool await_ready() const noexcept
+    {
+      return m_task.done();
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+      m_task.promise().SetContinuation(awaiter);
+      return m_task;
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+
+  private:
+    std::coroutine_handle<Promise<T>> m_task;
+  };
+
+} // detail namespace
+
+  // Lazily started coroutine producing a T. co_await starts it and resumes the awaiter
+  // with its result, or rethrows what it threw, on whatever thread the task finished on;
+  // a task that co_awaits pool.Schedule() hands its awaiter over to a pool worker that way.
+  // Frames come from detail::FrameAllocator. A Task is awaited at most once.
+  template <typename T>
+  class [[nodiscard]] Task final
+  {
+  public:
+    using promise_type = detail::Promise<T>;
+    using handle_t = std::coroutine_handle<promise_type>;
+
+    Task() noexcept
+      : m_handle{nullptr}
+    {
+    }
+
+    explicit Task(handle_t handle) noexcept
+      : m_handle{handle}
+    {
+    }
+
+    Task(Task&& rhs) noexcept
+      : m_handle{std::exchange(rhs.m_handle, nullptr)}
+    {
+    }
+
+    Task& operator=(Task&& rhs) noexcept
+    {
+      if (this != &rhs)
+      {
+        if (m_handle)
+          m_handle.destroy();
+        m_handle = std::exchange(rhs.m_handle, nullptr);
+      }
+      return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task()
+    {
+      if (m_handle)
+        m_handle.destroy();
+    }
+
+    bool Valid() const noexcept
+    {
+      return static_cast<bool>(m_handle);
+    }
+
+    bool Done() const noexcept
+    {
+      return m_handle && m_handle.done();
+    }
+
+    // throws std::logic_error if the task is empty
+    auto operator co_await() &&
+    {
+      detail::ExpectTask(Valid());
+      struct Awaiter : detail::ReadyAwaiter<T>
+      {
+        T await_resume()
+        {
+          return m_handle.promise().Result();
+        }
+
+        handle_t m_handle;
+      };
+      return Awaiter{detail::ReadyAwaiter<T>{m_handle}, m_handle};
+    }
+
+  private:
+    friend struct detail::TaskAccess;
+
+    handle_t m_handle;
+  };
+
+namespace detail
+{
+  template <typename T>
+  Task<T> Promise<T>::get_return_object() noexcept
+  {
+    return Task<T>{std::coroutine_handle<Promise<T>>::from_promise(*this)};
+  }
+
+  inline Task<void> Promise<void>::get_return_object() noexcept
+  {
+    return Task<void>{std::coroutine_handle<Promise<void>>::from_promise(*this)};
+  }
+
+  // the coroutine SyncWait blocks on, it signals the waiting thread from its final suspend
+  class SyncWaiter final
+  {
+  public:
+    struct Signal
+    {
+      std::mutex m_mutex;
+      std::condition_variable m_condition;
+      bool m_done = false;
+    };
+
+    struct promise_type
+    {
+      struct FinalAwaiter
+      {
+        bool await_ready() const noexcept
+        {
+          return false;
+        }
+
+        void await_suspend(std::coroutine_handle<promise_type> coroutine) const noexcept
+        {
+          // the lock is held until the notification is out, so the waiter cannot return
+          // and take the signal with it before
+          Signal& signal = *coroutine.promise().m_signal;
+          std::lock_guard<std::mutex> lock{signal.m_mutex};
+          signal.m_done = true;
+          signal.m_condition.notify_all();
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+      };
+
+      SyncWaiter get_return_object() noexcept
+      {
+        return SyncWaiter{std::coroutine_handle<promise_type>::from_promise(*this)};
+      }
+
+      std::suspend_always initial_suspend() const noexcept
+      {
+        return {};
+      }
+
+      FinalAwaiter final_suspend() const noexcept
+      {
+        return {};
+      }
+
+      void return_void() const noexcept
+      {
+      }
+
+      // the awaited task keeps its own exceptions, nothing else in here throws
+      void unhandled_exception() const noexcept
+      {
+        std::terminate();
+      }
+
+      Signal* m_signal = nullptr;
+    };
+
+    explicit SyncWaiter(std::coroutine_handle<promise_type> handle) noexcept
+      : m_handle{handle}
+    {
+    }
+
+    SyncWaiter(const SyncWaiter&) = delete;
+    SyncWaiter& operator=(const SyncWaiter&) = delete;
+
+    ~SyncWaiter()
+    {
+      m_handle.destroy();
+    }
+
+    void Run()
+    {
+      Signal signal;
+      m_handle.promise().m_signal = &signal;
+      m_handle.resume();
+
+      std::unique_lock<std::mutex> lock{signal.m_mutex};
+      signal.m_condition.wait(lock, [&signal] { return signal.m_done; });
+    }
+
+  private:
+    std::coroutine_handle<promise_type> m_handle;
+  };
+
+  template <typename T>
+  SyncWaiter MakeSyncWaiter(const Task<T>& task)
+  {
+    co_await ReadyAwaiter<T>{TaskAccess::Handle(task)};
+  }
+
+  // one per task of a WhenAll, the last one to finish resumes the WhenAll
+  class WhenAllChild final
+  {
+  public:
+    struct promise_type
+    {
+      struct FinalAwaiter
+      {
+        bool await_ready() const noexcept
+        {
+          return false;
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> coroutine) const noexcept
+        {
+          promise_type& promise = coroutine.promise();
+          if (promise.m_remaining->fetch_sub(1, std::memory_order_acq_rel) == 1)
+            return promise.m_parent;
+          return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+      };
+
+      WhenAllChild get_return_object() noexcept
+      {
+        return WhenAllChild{std::coroutine_handle<promise_type>::from_promise(*this)};
+      }
+
+      std::suspend_always initial_suspend() const noexcept
+      {
+        return {};
+      }
+
+      FinalAwaiter final_suspend() const noexcept
+      {
+        return {};
+      }
+
+      void return_void() const noexcept
+      {
+      }
+
+      void unhandled_exception() const noexcept
+      {
+        std::terminate();
+      }
+
+      static void* operator new(size_t size)
+      {
+        return FrameAllocator::Allocate(size);
+      }
+
+      static void operator delete(void* frame, size_t size) noexcept
+      {
+        FrameAllocator::Deallocate(frame, size);
+      }
+
+      std::atomic<size_t>* m_remaining = nullptr;
+      std::coroutine_handle<> m_parent;
+    };
+
+    explicit WhenAllChild(std::coroutine_handle<promise_type> handle) noexcept
+      : m_handle{handle}
+    {
+    }
+
+    WhenAllChild(WhenAllChild&& rhs) noexcept
+      : m_handle{std::exchange(rhs.m_handle, nullptr)}
+    {
+    }
+
+    WhenAllChild(const WhenAllChild&) = delete;
+    WhenAllChild& operator=(const WhenAllChild&) = delete;
+    WhenAllChild& operator=(WhenAllChild&&) = delete;
+
+    ~WhenAllChild()
+    {
+      if (m_handle)
+        m_handle.destroy();
+    }
+
+    void Start(std::atomic<size_t>& remaining, std::coroutine_handle<> parent) noexcept
+    {
+      m_handle.promise().m_remaining = &remaining;
+      m_handle.promise().m_parent = parent;
+      m_handle.resume();
+    }
+
+  private:
+    std::coroutine_handle<promise_type> m_handle;
+  };
+
+  template <typename T>
+  WhenAllChild MakeWhenAllChild(const Task<T>& task)
+  {
+    co_await ReadyAwaiter<T>{TaskAccess::Handle(task)};
+  }
+
+  // starts every task and resumes the awaiter once all of them finished
+  template <typename T>
+  class AllReadyAwaiter
+  {
+  public:
+    explicit AllReadyAwaiter(const std::vector<Task<T>>& tasks) noexcept
+      : m_tasks{tasks}
+      , m_remaining{tasks.size() + 1}
+    {
+    }
+
+    bool await_ready() const noexcept
+    {
+      return m_tasks.empty();
+    }
+
+    // the extra count keeps the last child from resuming us before every child started
+    bool await_suspend(std::coroutine_handle<> awaiter)
+    {
+      m_children.reserve(m_tasks.size());
+      for (const Task<T>& task : m_tasks)
+        m_children.push_back(MakeWhenAllChild(task));
+      for (WhenAllChild& child : m_children)
+        child.Start(m_remaining, awaiter);
+      return m_remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+    }
+
+    void await_resume() noexcept
+    {
+      m_children.clear();
+    }
+
+  private:
+    const std::vector<Task<T>>& m_tasks;
+    std::atomic<size_t> m_remaining;
+    std::vector<WhenAllChild> m_children;
+  };
+
+} // detail namespace
+
+  // runs task to completion on the calling thread and whichever threads it hops to, and
+  // blocks until it is done. Meant for tests and main(), not for use inside a coroutine
+  template <typename T>
+  T SyncWait(Task<T> task)
+  {
+    detail::ExpectTask(task.Valid());
+    detail::SyncWaiter waiter = detail::MakeSyncWaiter(task);
+    waiter.Run();
+    return detail::TaskAccess::Handle(task).promise().Result();
+  }
+
+  // starts all tasks at once and finishes when the last of them did, with their results in
+  // order. The first exception, in task order, is rethrown once all of them finished
+  template <typename T>
+  Task<std::vector<T>> WhenAll(std::vector<Task<T>> tasks)
+  {
+    for (const Task<T>& task : tasks)
+      detail::ExpectTask(task.Valid());
+    co_await detail::AllReadyAwaiter<T>{tasks};
+
+    std::vector<T> results;
+    results.reserve(tasks.size());
+    for (const Task<T>& task : tasks)
+      results.push_back(detail::TaskAccess::Handle(task).promise().Result());
+    co_return results;
+  }
+
+  inline Task<void> WhenAll(std::vector<Task<void>> tasks)
+  {
+    for (const Task<void>& task : tasks)
+      detail::ExpectTask(task.Valid());
+    co_await detail::AllReadyAwaiter<void>{tasks};
+
+    for (const Task<void>& task : tasks)
+      detail::TaskAccess::Handle(task).promise().Result();
+  }
+
+} // coro namespace
+
+} // namespace regit::async
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace regit::async {
+
+  // [Begin, End) in steps of at most Grain elements
+  template <typename IndexT>
+  struct IndexRange
+  {
+    IndexT Begin;
+    IndexT End;
+    IndexT Grain = 1;
+  };
+
+namespace detail
+{
+  // what every piece of one ParallelFor/ParallelReduce shares; lives on the caller's stack
+  class LoopState
+  {
+  public:
+    explicit LoopState(uint64_t count) noexcept
+      : m_remaining{count}
+      , m_failed{false}
+    {
+    }
+
+    // the last access any piece makes, once it reaches 0 the caller may return
+    void Done(uint64_t count) noexcept
+    {
+      m_remaining.fetch_sub(count, std::memory_order_acq_rel);
+    }
+
+    bool Finished() const noexcept
+    {
+      return !m_remaining.load(std::memory_order_acquire);
+    }
+
+    // keeps the first exception, the rest of the loop is skipped
+    void Fail(std::exception_ptr exception) noexcept
+    {
+      if (!m_failed.exchange(true, std::memory_order_acq_rel))
+        m_exception = std::move(exception);
+    }
+
+    bool Failed() const noexcept
+    {
+      return m_failed.load(std::memory_order_relaxed);
+    }
+
+    void Rethrow() const
+    {
+      if (m_exception)
+        std::rethrow_exception(m_exception);
+    }
+
+  private:
+    std::atomic<uint64_t> m_remaining;
+    std::atomic_bool m_failed;
+    std::exception_ptr m_exception;
+  };
+
+  // Lazy binary splitting: a piece works through its range grain by grain, and only when
+  // the queue it posts to has run dry does it hand the right half of what is left to the
+  // pool. Busy pools therefore split rarely and idle ones get work as soon as they ask.
+  // ContextT::Run(begin, end) processes elements, ContextT::Split() returns the context
+  // for a right half that is about to be posted.
+  template <typename PoolT, typename IndexT, typename ContextT>
+  void RunPiece(PoolT& pool, LoopState& state, IndexT begin, IndexT end, IndexT grain, ContextT& context) noexcept
+  {
+    const IndexT first = begin;
+    try
+    {
+      while (end - begin > grain && !state.Failed())
+      {
+        if (pool.LocalQueueEmpty())
+        {
+          const IndexT middle = begin + (end - begin) / 2;
+          ContextT& right = context.Split();
+          pool.Post(
+            [&pool, &state, middle, end, grain, &right]
+            {
+              RunPiece(pool, state, middle, end, grain, right);
+            });
+          end = middle;
+        }
+        else
+        {
+          context.Run(begin, begin + grain);
+          begin += grain;
+        }
+      }
+      if (!state.Failed())
+        context.Run(begin, end);
+    }
+    catch (...)
+    {
+      state.Fail(std::current_exception());
+    }
+    state.Done(end - first);
+  }
+
+  // runs whatever the pool has queued until every piece is done, without sleeping
+  template <typename PoolT>
+  void HelpUntilDone(PoolT& pool, const LoopState& state)
+  {
+    while (!state.Finished())
+      if (!pool.TryRunOne())
+        std::this_thread::yield();
+    state.Rethrow();
+  }
+
+  template <typename FuncT>
+  class ForContext
+  {
+  public:
+    explicit ForContext(FuncT& func) noexcept
+      : m_func{func}
+    {
+    }
+
+    template <typename IndexT>
+    void Run(IndexT begin, IndexT end)
+    {
+      for (IndexT i = begin; i != end; ++i)
+        m_func(i);
+    }
+
+    // stateless, every piece can share it
+    ForContext& Split() noexcept
+    {
+      return *this;
+    }
+
+  private:
+    FuncT& m_func;
+  };
+
+  // One per piece. A piece covers a contiguous run on the left of its range and posts the
+  // right halves it splits off from right to left, so its partial result followed by its
+  // children's in reverse order is the result of the whole range in order.
+  template <typename T, typename FuncT>
+  class ReduceContext
+  {
+  public:
+    ReduceContext(const T& identity, FuncT& func)
+      : m_value{identity}
+      , m_identity{identity}
+      , m_func{func}
+    {
+    }
+
+    template <typename IndexT>
+    void Run(IndexT begin, IndexT end)
+    {
+      for (IndexT i = begin; i != end; ++i)
+        m_value = m_func(std::move(m_value), i);
+    }
+
+    ReduceContext& Split()
+    {
+      m_children.emplace_back(std::make_unique<ReduceContext>(m_identity, m_func));
+      return *m_children.back();
+    }
+
+    template <typename CombineT>
+    T Fold(CombineT& combine)
+    {
+      T result = std::move(m_value);
+      for (auto child = m_children.rbegin(); child != m_children.rend(); ++child)
+        result = combine(std::move(result), (*child)->Fold(combine));
+      return result;
+    }
+
+  private:
+    T m_value;
+    const T& m_identity;
+    FuncT& m_func;
+    std::vector<std::unique_ptr<ReduceContext>> m_children;
+  };
+
+} // detail namespace
+
+  // Calls func(i) for every i in [begin, end) on the pool and on the calling thread, and
+  // returns once all of them ran. Chunks never get smaller than grain elements. The first
+  // exception func throws stops the loop early and is rethrown here.
+  template <typename PoolT, typename IndexT, typename FuncT>
+  void ParallelFor(PoolT& pool, IndexT begin, std::common_type_t<IndexT> end, std::common_type_t<IndexT> grain, FuncT&& func)
+  {
+    static_assert(std::is_integral_v<IndexT>);
+    if (!(begin < end))
+      return;
+
+    detail::LoopState state(end - begin);
+    detail::ForContext<std::remove_reference_t<FuncT>> context{func};
+    detail::RunPiece(pool, state, begin, end, grain > 0 ? grain : 1, context);
+    detail::HelpUntilDone(pool, state);
+  }
+
+  template <typename PoolT, typename IndexT, typename FuncT>
+  void ParallelFor(PoolT& pool, const IndexRange<IndexT>& range, FuncT&& func)
+  {
+    ParallelFor(pool, range.Begin, range.End, range.Grain, std::forward<FuncT>(func));
+  }
+
+  // Folds [range.Begin, range.End) with func(T accumulated, IndexT i) -> T, starting every
+  // chunk at identity, and merges the chunks with combine(T left, T right) -> T. Chunks are
+  // combined in index order, so combine only needs to be associative.
+  template <typename PoolT, typename IndexT, typename T, typename FuncT, typename CombineT>
+  T ParallelReduce(PoolT& pool, const IndexRange<IndexT>& range, T identity, FuncT&& func, CombineT&& combine)
+  {
+    static_assert(std::is_integral_v<IndexT>);
+    if (!(range.Begin < range.End))
+      return identity;
+
+    detail::LoopState state(range.End - range.Begin);
+    detail::ReduceContext<T, std::remove_reference_t<FuncT>> root{identity, func};
+    detail::RunPiece(pool, state, range.Begin, range.End, range.Grain > 0 ? range.Grain : 1, root);
+    detail::HelpUntilDone(pool, state);
+    return root.Fold(combine);
+  }
+
+} // namespace regit::async
@@ -0,0 +1,405 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace regit::async {
+
+  // Move-only void() callable. Callables that fit INLINE_SIZE and move without throwing are
+  // stored in place, so the common small closure never touches the allocator, anything
+  // bigger falls back to the heap. A Task is exactly one cache line.
+  class Task final
+  {
+  public:
+    static constexpr size_t INLINE_SIZE = 64 - sizeof(void*);
+
+    template <typename FuncT>
+    static constexpr bool is_inline_v =
+      sizeof(FuncT) <= INLINE_SIZE &&
+      alignof(FuncT) <= alignof(std::max_align_t) &&
+      std::is_nothrow_move_constructible_v<FuncT>;
+
+    Task() noexcept
+      : m_ops{nullptr}
+    {
+    }
+
+    template <
+      typename FuncT,
+      typename DecayedT = std::decay_t<FuncT>,
+      std::enable_if_t<!std::is_same_v<DecayedT, Task> && std::is_invocable_v<DecayedT&>, int> = 0>
+    Task(FuncT&& func)
+      : m_ops{nullptr}
+    {
+      if constexpr (std::is_pointer_v<DecayedT> || std::is_same_v<DecayedT, std::function<void()>>)
+      {
+        // an empty std::function or null function pointer makes an empty Task
+        if (!static_cast<bool>(func))
+          return;
+      }
+
+      if constexpr (is_inline_v<DecayedT>)
+        ::new (static_cast<void*>(m_storage)) DecayedT(std::forward<FuncT>(func));
+      else
+        ::new (static_cast<void*>(m_storage)) DecayedT*(new DecayedT(std::forward<FuncT>(func)));
+      m_ops = &OPS<DecayedT>;
+    }
+
+    Task(Task&& rhs) noexcept
+      : m_ops{rhs.m_ops}
+    {
+      if (m_ops)
+        m_ops->Relocate(rhs.m_storage, m_storage);
+      rhs.m_ops = nullptr;
+    }
+
+    Task& operator=(Task&& rhs) noexcept
+    {
+      if (this != &rhs)
+      {
+        Reset();
+        m_ops = rhs.m_ops;
+        if (m_ops)
+          m_ops->Relocate(rhs.m_storage, m_storage);
+        rhs.m_ops = nullptr;
+      }
+      return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task()
+    {
+      Reset();
+    }
+
+    void operator()()
+    {
+      m_ops->Invoke(m_storage);
+    }
+
+    explicit operator bool() const noexcept
+    {
+      return m_ops != nullptr;
+    }
+
+  private:
+    struct Ops
+    {
+      void (*Invoke)(void* storage);
+      // move constructs into to and destroys from
+      void (*Relocate)(void* from, void* to) noexcept;
+      void (*Destroy)(void* storage) noexcept;
+    };
+
+    template <typename FuncT>
+    static FuncT& Get(void* storage) noexcept
+    {
+      if constexpr (is_inline_v<FuncT>)
+        return *std::launder(static_cast<FuncT*>(storage));
+      else
+        return **std::launder(static_cast<FuncT**>(storage));
+    }
+
+    template <typename FuncT>
+    static constexpr Ops OPS = {
+      [](void* storage) { Get<FuncT>(storage)(); },
+      [](void* from, void* to) noexcept
+      {
+        if constexpr (is_inline_v<FuncT>)
+        {
+          FuncT& func = Get<FuncT>(from);
+          ::new (to) FuncT(std::move(func));
+          func.~FuncT();
+        }
+        else
+          ::new (to) FuncT*(&Get<FuncT>(from));
+      },
+      [](void* storage) noexcept
+      {
+        if constexpr (is_inline_v<FuncT>)
+          Get<FuncT>(storage).~FuncT();
+        else
+          delete &Get<FuncT>(storage);
+      }};
+
+    void Reset() noexcept
+    {
+      if (m_ops)
+        m_ops->Destroy(m_storage);
+      m_ops = nullptr;
+    }
+
+    alignas(std::max_align_t) unsigned char m_storage[INLINE_SIZE];
+    const Ops* m_ops;
+  };
+
+  static_assert(sizeof(Task) == 64);
+
+  template <typename T>
+  class Future;
+
+namespace detail
+{
+  // Result of a Submit, shared by the Future and the task that produces it. Only one thread
+  // ever sets it; waiters only take the lock if the result is not there yet.
+  template <typename T>
+  class SharedState
+  {
+  public:
+    SharedState() noexcept
+      : m_references{2}
+      , m_ready{false}
+      , m_waiters{0}
+    {
+    }
+
+    virtual ~SharedState() = default;
+
+    void SetException(std::exception_ptr exception) noexcept
+    {
+      m_exception = std::move(exception);
+      Publish();
+    }
+
+    bool Ready() const noexcept
+    {
+      return m_ready.load(std::memory_order_acquire);
+    }
+
+    void Wait()
+    {
+      if (Ready())
+        return;
+
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_waiters.fetch_add(1, std::memory_order_seq_cst);
+      m_condition.wait(lock, [this] { return Ready(); });
+      m_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    T Take()
+    {
+      Wait();
+      if (m_exception)
+        std::rethrow_exception(m_exception);
+      if constexpr (!std::is_void_v<T>)
+        return std::move(*m_value);
+    }
+
+    void Release() noexcept
+    {
+      if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+    }
+
+  protected:
+    // stores the result of func, or what it threw, without handing it out yet
+    template <typename FuncT>
+    void Store(FuncT&& func) noexcept
+    {
+      try
+      {
+        if constexpr (std::is_void_v<T>)
+          func();
+        else
+          m_value.emplace(func());
+      }
+      catch (...)
+      {
+        m_exception = std::current_exception();
+      }
+    }
+
+    // once this returns waiters may take the result and the caller's scope may end
+    void Publish() noexcept
+    {
+      m_ready.store(true, std::memory_order_seq_cst);
+      if (m_waiters.load(std::memory_order_seq_cst))
+      {
+        // the waiter is either before its check and sees m_ready or inside wait and gets notified
+        { std::lock_guard<std::mutex> lock{m_mutex}; }
+        m_condition.notify_all();
+      }
+    }
+
+  private:
+    using value_t = std::conditional_t<std::is_void_v<T>, bool, T>;
+
+    std::atomic<int> m_references;
+    std::atomic_bool m_ready;
+    std::atomic<int> m_waiters;
+    std::optional<value_t> m_value;
+    std::exception_ptr m_exception;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+  };
+
+  // the callable and its arguments live in the same allocation as the result
+  template <typename T, typename FuncT, typename ... ArgsT>
+  class SubmitState final : public SharedState<T>
+  {
+  public:
+    template <typename ... ForwardT>
+    explicit SubmitState(ForwardT&& ... call)
+      : m_call{std::in_place, std::forward<ForwardT>(call)...}
+    {
+    }
+
+    void Run() noexcept
+    {
+      this->Store(
+        [this] { return std::apply([](auto& func, auto& ... args) { return std::invoke(std::move(func), std::move(args)...); }, *m_call); });
+      // whatever the call captured is gone before Get returns, it may refer to the caller's scope
+      m_call.reset();
+      this->Publish();
+    }
+
+  private:
+    std::optional<std::tuple<FuncT, ArgsT...>> m_call;
+  };
+
+  // the Task side of a Submit, small enough to be stored inline
+  template <typename T, typename StateT>
+  class SubmitCall final
+  {
+  public:
+    explicit SubmitCall(StateT* state) noexcept
+      : m_state{state}
+    {
+    }
+
+    SubmitCall(SubmitCall&& rhs) noexcept
+      : m_state{std::exchange(rhs.m_state, nullptr)}
+    {
+    }
+
+    SubmitCall(const SubmitCall&) = delete;
+    SubmitCall& operator=(const SubmitCall&) = delete;
+    SubmitCall& operator=(SubmitCall&&) = delete;
+
+    ~SubmitCall()
+    {
+      if (!m_state)
+        return;
+      // dropped without running, e.g. the pool stopped first
+      m_state->SetException(std::make_exception_ptr(std::future_error{std::future_errc::broken_promise}));
+      m_state->Release();
+    }
+
+    void operator()()
+    {
+      StateT* state = std::exchange(m_state, nullptr);
+      state->Run();
+      state->Release();
+    }
+
+  private:
+    StateT* m_state;
+  };
+
+} // detail namespace
+
+  // Move-only handle to the result of a GenericThreadPool::Submit
+  template <typename T>
+  class Future final
+  {
+  public:
+    Future() noexcept
+      : m_state{nullptr}
+    {
+    }
+
+    explicit Future(detail::SharedState<T>* state) noexcept
+      : m_state{state}
+    {
+    }
+
+    Future(Future&& rhs) noexcept
+      : m_state{std::exchange(rhs.m_state, nullptr)}
+    {
+    }
+
+    Future& operator=(Future&& rhs) noexcept
+    {
+      if (this != &rhs)
+      {
+        if (m_state)
+          m_state->Release();
+        m_state = std::exchange(rhs.m_state, nullptr);
+      }
+      return *this;
+    }
+
+    Future(const Future&) = delete;
+    Future& operator=(const Future&) = delete;
+
+    ~Future()
+    {
+      if (m_state)
+        m_state->Release();
+    }
+
+    bool Valid() const noexcept
+    {
+      return m_state != nullptr;
+    }
+
+    bool Ready() const noexcept
+    {
+      return m_state->Ready();
+    }
+
+    void Wait() const
+    {
+      m_state->Wait();
+    }
+
+    // blocks until the result is there and returns it, or rethrows what the task threw
+    T Get()
+    {
+      detail::SharedState<T>* state = std::exchange(m_state, nullptr);
+      struct Releaser
+      {
+        detail::SharedState<T>* m_state;
+        ~Releaser() { m_state->Release(); }
+      } releaser{state};
+      return state->Take();
+    }
+
+  private:
+    detail::SharedState<T>* m_state;
+  };
+
+namespace detail
+{
+  // the call runs once and gets its decayed arguments as rvalues, like std::async.
+  // Results are handed out by value, a reference returned by the callable is copied
+  template <typename FuncT, typename ... ArgsT>
+  using submit_result_t = std::decay_t<std::invoke_result_t<std::decay_t<FuncT>, std::decay_t<ArgsT>...>>;
+
+  // one allocation for the callable, its arguments and the result
+  template <typename FuncT, typename ... ArgsT>
+  std::pair<Task, Future<submit_result_t<FuncT, ArgsT...>>> MakeSubmission(FuncT&& func, ArgsT&& ... args)
+  {
+    using result_t = submit_result_t<FuncT, ArgsT...>;
+    using state_t = SubmitState<result_t, std::decay_t<FuncT>, std::decay_t<ArgsT>...>;
+
+    auto* state = new state_t{std::forward<FuncT>(func), std::forward<ArgsT>(args)...};
+    return {Task{SubmitCall<result_t, state_t>{state}}, Future<result_t>{state}};
+  }
+
+} // detail namespace
+
+} // namespace regit::async
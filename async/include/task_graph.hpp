@@ -0,0 +1,341 @@
+#pragma once
+
+#include <async/include/task.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <initializer_list>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace regit::async {
+
+  class TaskGraph;
+
+namespace detail
+{
+  struct GraphNode
+  {
+    explicit GraphNode(Task work, TaskGraph* subgraph = nullptr) noexcept
+      : m_work{std::move(work)}
+      , m_subgraph{subgraph}
+      , m_predecessors{0}
+      , m_pending{0}
+    {
+    }
+
+    Task m_work;
+    // not owned, runs in place of m_work
+    TaskGraph* m_subgraph;
+    std::vector<size_t> m_successors;
+    size_t m_predecessors;
+    // predecessors that have not finished yet in the current run
+    std::atomic<size_t> m_pending;
+  };
+
+} // detail namespace
+
+  template <typename PoolT>
+  class GraphRun;
+
+  // DAG of tasks that is built once and run many times on a GenericThreadPool. Every run
+  // resets a counter per node to its number of predecessors, and whichever predecessor
+  // brings it to zero schedules the node: it keeps one ready successor to run itself and
+  // posts the others, so the critical path never waits for a level to drain.
+  // A node can be a whole other TaskGraph, which counts as finished once all of its nodes
+  // are. The graph must not change while it runs and one graph only runs once at a time.
+  class TaskGraph final
+  {
+  public:
+    using node_t = size_t;
+
+    TaskGraph()
+      : m_remaining{0}
+      , m_running{false}
+      , m_failed{false}
+      , m_validated{true}
+      , m_parent{nullptr}
+      , m_parentNode{0}
+    {
+    }
+
+    // in flight runs point into the graph
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph(TaskGraph&&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+    TaskGraph& operator=(TaskGraph&&) = delete;
+
+    ~TaskGraph() = default;
+
+    // adds a node running func, which may be called once per run
+    template <typename FuncT>
+    node_t Emplace(FuncT&& func, std::initializer_list<node_t> predecessors = {})
+    {
+      m_nodes.emplace_back(Task{std::forward<FuncT>(func)});
+      return Link(predecessors);
+    }
+
+    // adds a node that runs all of subgraph, which has to outlive this graph
+    node_t EmplaceSubgraph(TaskGraph& subgraph, std::initializer_list<node_t> predecessors = {})
+    {
+      m_nodes.emplace_back(Task{}, &subgraph);
+      return Link(predecessors);
+    }
+
+    // successor only starts once predecessor finished
+    void AddDependency(node_t predecessor, node_t successor)
+    {
+      if (predecessor >= m_nodes.size() || successor >= m_nodes.size())
+        throw std::out_of_range{"array out of bounds!"};
+
+      m_nodes[predecessor].m_successors.push_back(successor);
+      ++m_nodes[successor].m_predecessors;
+      m_validated = false;
+    }
+
+    size_t Size() const noexcept
+    {
+      return m_nodes.size();
+    }
+
+    bool Running() const noexcept
+    {
+      return m_running.load(std::memory_order_acquire);
+    }
+
+    // posts the nodes without predecessors and returns right away, wait on the result
+    template <typename PoolT>
+    GraphRun<PoolT> Run(PoolT& pool)
+    {
+      if (!Start(pool, nullptr, 0))
+        throw std::logic_error{"task graph is already running!"};
+      return GraphRun<PoolT>{*this, pool};
+    }
+
+  private:
+    template <typename PoolT>
+    friend class GraphRun;
+
+    node_t Link(std::initializer_list<node_t> predecessors)
+    {
+      const node_t node = m_nodes.size() - 1;
+      m_validated = false;
+      for (node_t predecessor : predecessors)
+        AddDependency(predecessor, node);
+      return node;
+    }
+
+    // Kahn's algorithm, only redone after the graph changed. Every graph checks itself when
+    // it starts, so a subgraph edited after its parent last ran is still picked up
+    void Validate()
+    {
+      if (m_validated)
+        return;
+
+      std::vector<size_t> pending(m_nodes.size());
+      std::vector<node_t> ready;
+      m_roots.clear();
+      for (node_t node = 0; node != m_nodes.size(); ++node)
+      {
+        pending[node] = m_nodes[node].m_predecessors;
+        if (!pending[node])
+        {
+          m_roots.push_back(node);
+          ready.push_back(node);
+        }
+      }
+
+      size_t visited = 0;
+      while (!ready.empty())
+      {
+        const node_t node = ready.back();
+        ready.pop_back();
+        ++visited;
+        for (node_t successor : m_nodes[node].m_successors)
+          if (!--pending[successor])
+            ready.push_back(successor);
+      }
+      if (visited != m_nodes.size())
+        throw std::invalid_argument{"task graph has a cycle!"};
+      m_validated = true;
+    }
+
+    // false if the graph is running already, throws if it has a cycle
+    template <typename PoolT>
+    bool Start(PoolT& pool, TaskGraph* parent, node_t parentNode)
+    {
+      if (m_running.exchange(true, std::memory_order_acq_rel))
+        return false;
+
+      try
+      {
+        Validate();
+      }
+      catch (...)
+      {
+        m_running.store(false, std::memory_order_release);
+        throw;
+      }
+
+      m_parent = parent;
+      m_parentNode = parentNode;
+      m_failed.store(false, std::memory_order_relaxed);
+      m_exception = nullptr;
+
+      if (m_nodes.empty())
+      {
+        Finish(pool);
+        return true;
+      }
+
+      for (auto& node : m_nodes)
+        node.m_pending.store(node.m_predecessors, std::memory_order_relaxed);
+      m_remaining.store(m_nodes.size(), std::memory_order_release);
+
+      // once the last root is posted the run may finish and the graph go away under us
+      const size_t roots = m_roots.size();
+      const node_t* root = m_roots.data();
+      for (size_t i = 0; i != roots; ++i)
+        Post(pool, root[i]);
+      return true;
+    }
+
+    template <typename PoolT>
+    void Post(PoolT& pool, node_t node)
+    {
+      pool.Post([this, &pool, node] { Execute(pool, node); });
+    }
+
+    template <typename PoolT>
+    void Execute(PoolT& pool, node_t node)
+    {
+      while (node != NONE)
+      {
+        detail::GraphNode& current = m_nodes[node];
+        const bool failed = m_failed.load(std::memory_order_relaxed);
+        if (current.m_subgraph && !failed)
+        {
+          // finishes asynchronously, the subgraph completes the node once it is done
+          try
+          {
+            if (current.m_subgraph->Start(pool, this, node))
+              return;
+            Fail(std::make_exception_ptr(std::logic_error{"task graph is already running!"}));
+          }
+          catch (...)
+          {
+            Fail(std::current_exception());
+          }
+          Complete(pool, node, false);
+          return;
+        }
+
+        if (current.m_work && !failed)
+        {
+          try
+          {
+            current.m_work();
+          }
+          catch (...)
+          {
+            Fail(std::current_exception());
+          }
+        }
+        node = Complete(pool, node, true);
+      }
+    }
+
+    // releases the successors of node; with keepOne the first ready successor is returned
+    // for the caller to run instead of being posted
+    template <typename PoolT>
+    node_t Complete(PoolT& pool, node_t node, bool keepOne)
+    {
+      node_t next = NONE;
+      for (node_t successor : m_nodes[node].m_successors)
+      {
+        if (m_nodes[successor].m_pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+          continue;
+        if (keepOne && next == NONE)
+          next = successor;
+        else
+          Post(pool, successor);
+      }
+
+      if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        Finish(pool);
+      return next;
+    }
+
+    // the last access a run makes to the graph
+    template <typename PoolT>
+    void Finish(PoolT& pool)
+    {
+      TaskGraph* parent = m_parent;
+      const node_t parentNode = m_parentNode;
+      if (parent && m_failed.load(std::memory_order_relaxed))
+        parent->Fail(m_exception);
+
+      m_running.store(false, std::memory_order_release);
+      if (parent)
+        parent->Complete(pool, parentNode, false);
+    }
+
+    // keeps the first exception, the nodes that have not started yet are skipped
+    void Fail(std::exception_ptr exception) noexcept
+    {
+      if (!m_failed.exchange(true, std::memory_order_acq_rel))
+        m_exception = std::move(exception);
+    }
+
+    static constexpr node_t NONE = ~node_t{0};
+
+    // a deque so nodes never move, they hold atomics
+    std::deque<detail::GraphNode> m_nodes;
+    std::vector<node_t> m_roots;
+    std::atomic<size_t> m_remaining;
+    std::atomic_bool m_running;
+    std::atomic_bool m_failed;
+    std::exception_ptr m_exception;
+    bool m_validated;
+    TaskGraph* m_parent;
+    node_t m_parentNode;
+  };
+
+  // One run of a TaskGraph. Wait does not sleep: until the graph is done the waiting thread
+  // runs whatever the pool has queued and only yields if there is nothing
+  template <typename PoolT>
+  class GraphRun final
+  {
+  public:
+    GraphRun(TaskGraph& graph, PoolT& pool) noexcept
+      : m_graph{graph}
+      , m_pool{pool}
+    {
+    }
+
+    bool Done() const noexcept
+    {
+      return !m_graph.Running();
+    }
+
+    // rethrows the first exception a node threw
+    void Wait()
+    {
+      while (m_graph.Running())
+        if (!m_pool.TryRunOne())
+          std::this_thread::yield();
+
+      if (m_graph.m_failed.load(std::memory_order_acquire))
+        std::rethrow_exception(m_graph.m_exception);
+    }
+
+  private:
+    TaskGraph& m_graph;
+    PoolT& m_pool;
+  };
+
+} // namespace regit::async
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <async/include/task.hpp>
+
 #include <atomic>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -16,7 +22,7 @@ namespace regit::async {
 
 namespace detail
 {
-  using work_t = std::function<void()>;
+  using work_t = Task;
   class NaiveThreadWrapper final
   {
   public:
@@ -44,7 +50,7 @@ namespace detail
   class DefaultWorkPolicy
   {
   public:
-    void BeginWork(const work_t& work) noexcept
+    void BeginWork(work_t& work) noexcept
     {
       try
       {
@@ -58,9 +64,524 @@ namespace detail
     }
   };
 
+  // Chase-Lev deque: the owning thread pushes and takes at the bottom, any other thread
+  // steals from the top, and they only race each other for the last element.
+  // T has to be trivially copyable since a thief may read a slot the owner is rewriting
+  template <typename T>
+  class WorkStealingDeque final
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    struct Ring
+    {
+      explicit Ring(int64_t capacity)
+        : m_mask{capacity - 1}
+        , m_slots{new std::atomic<T>[static_cast<size_t>(capacity)]}
+      {
+      }
+
+      int64_t Capacity() const noexcept
+      {
+        return m_mask + 1;
+      }
+
+      T Get(int64_t index) const noexcept
+      {
+        return m_slots[static_cast<size_t>(index & m_mask)].load(std::memory_order_relaxed);
+      }
+
+      void Put(int64_t index, T value) noexcept
+      {
+        m_slots[static_cast<size_t>(index & m_mask)].store(value, std::memory_order_relaxed);
+      }
+
+      const int64_t m_mask;
+      std::unique_ptr<std::atomic<T>[]> m_slots;
+    };
+
+  public:
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // capacity is rounded up to a power of two and doubles whenever the owner runs out of room
+    explicit WorkStealingDeque(size_t capacity = 256)
+      : m_top{0}
+      , m_bottom{0}
+    {
+      int64_t size = 2;
+      while (size < static_cast<int64_t>(capacity))
+        size <<= 1;
+      m_rings.emplace_back(std::make_unique<Ring>(size));
+      m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+    }
+
+    // owner only
+    void Push(T value)
+    {
+      const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+      const int64_t top = m_top.load(std::memory_order_acquire);
+      Ring* ring = m_ring.load(std::memory_order_relaxed);
+      if (bottom - top > ring->m_mask)
+        ring = Grow(ring, top, bottom);
+
+      ring->Put(bottom, value);
+      // publishes the slot, and whatever value points to, to the thieves' acquire of m_bottom
+      m_bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    // owner only, takes the most recently pushed element
+    bool Take(T& value) noexcept
+    {
+      const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+      Ring* ring = m_ring.load(std::memory_order_relaxed);
+      m_bottom.store(bottom, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int64_t top = m_top.load(std::memory_order_relaxed);
+
+      if (top > bottom)
+      {
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+      }
+
+      value = ring->Get(bottom);
+      if (top != bottom)
+        return true;
+
+      // last element, race the thieves for it
+      const bool won = m_top.compare_exchange_strong(
+        top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      return won;
+    }
+
+    // any thread, takes the oldest element; false if empty or another thread got there first
+    bool Steal(T& value) noexcept
+    {
+      int64_t top = m_top.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+      if (top >= bottom)
+        return false;
+
+      Ring* ring = m_ring.load(std::memory_order_acquire);
+      value = ring->Get(top);
+      return m_top.compare_exchange_strong(
+        top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    // a snapshot, only exact while nobody else touches the deque
+    bool Empty() const noexcept
+    {
+      return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+    }
+
+    size_t Size() const noexcept
+    {
+      const int64_t size = m_bottom.load(std::memory_order_relaxed) - m_top.load(std::memory_order_relaxed);
+      return size > 0 ? static_cast<size_t>(size) : 0;
+    }
+
+  private:
+    Ring* Grow(Ring* ring, int64_t top, int64_t bottom)
+    {
+      auto grown = std::make_unique<Ring>(ring->Capacity() * 2);
+      for (int64_t i = top; i != bottom; ++i)
+        grown->Put(i, ring->Get(i));
+
+      // thieves may still be reading the old ring, so it is only freed with the deque
+      m_rings.emplace_back(std::move(grown));
+      m_ring.store(m_rings.back().get(), std::memory_order_release);
+      return m_rings.back().get();
+    }
+
+    alignas(64) std::atomic<int64_t> m_top;
+    alignas(64) std::atomic<int64_t> m_bottom;
+    std::atomic<Ring*> m_ring;
+    std::vector<std::unique_ptr<Ring>> m_rings;
+  };
+
+  // every worker pops from one queue behind one lock
+  class SharedQueueScheduler
+  {
+  public:
+    explicit SharedQueueScheduler(size_t) noexcept
+      : m_stopping{false}
+      , m_pending{0}
+    {
+    }
+
+    void Attach(size_t) noexcept
+    {
+    }
+
+    void Push(work_t work)
+    {
+      {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_jobs.emplace(std::move(work));
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+      }
+      m_condition.notify_one();
+    }
+
+    // blocks until there is work, false once the scheduler is stopped
+    bool Pop(size_t, work_t& work)
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_condition.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+
+      if (m_stopping)
+        return false;
+
+      work = std::move(m_jobs.front());
+      m_jobs.pop();
+      m_pending.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    // never blocks, for threads that help out while they wait
+    bool TryPop(work_t& work)
+    {
+      if (!m_pending.load(std::memory_order_relaxed))
+        return false;
+
+      std::lock_guard<std::mutex> lock{m_mutex};
+      if (m_jobs.empty())
+        return false;
+
+      work = std::move(m_jobs.front());
+      m_jobs.pop();
+      m_pending.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    // true if nothing is waiting in the queue the calling thread posts to
+    bool LocalQueueEmpty() const noexcept
+    {
+      return !m_pending.load(std::memory_order_relaxed);
+    }
+
+    void Stop()
+    {
+      {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_stopping = true;
+      }
+      m_condition.notify_all();
+    }
+
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping;
+    std::queue<work_t> m_jobs;
+    // mirrors m_jobs.size() for the lock free checks
+    std::atomic<size_t> m_pending;
+  };
+
+  // which scheduler the calling thread works for, if any
+  struct WorkerContext
+  {
+    const void* m_scheduler = nullptr;
+    size_t m_index = 0;
+  };
+
+  struct TaskNode
+  {
+    work_t m_work;
+    TaskNode* m_next = nullptr;
+  };
+
+  // Per thread free list of the nodes WorkStealingDeque slots point to. Most tasks are taken
+  // by the worker that pushed them, so nodes keep cycling through the same cache.
+  class TaskNodeCache final
+  {
+  public:
+    static constexpr size_t MAX_SIZE = 1024;
+
+    TaskNodeCache() = default;
+    TaskNodeCache(const TaskNodeCache&) = delete;
+    TaskNodeCache& operator=(const TaskNodeCache&) = delete;
+
+    ~TaskNodeCache()
+    {
+      while (m_head)
+        delete std::exchange(m_head, m_head->m_next);
+    }
+
+    TaskNode* Acquire(work_t work)
+    {
+      if (!m_head)
+        return new TaskNode{std::move(work)};
+
+      TaskNode* node = std::exchange(m_head, m_head->m_next);
+      --m_size;
+      node->m_work = std::move(work);
+      return node;
+    }
+
+    // moves the work out and recycles the node
+    work_t Release(TaskNode* node) noexcept
+    {
+      work_t work{std::move(node->m_work)};
+      if (m_size == MAX_SIZE)
+      {
+        delete node;
+        return work;
+      }
+      node->m_next = m_head;
+      m_head = node;
+      ++m_size;
+      return work;
+    }
+
+  private:
+    TaskNode* m_head = nullptr;
+    size_t m_size = 0;
+  };
+
+  // Every worker owns a WorkStealingDeque. Work posted from a worker goes to its own deque,
+  // work posted from anywhere else goes to a shared injection queue. A worker that runs dry
+  // checks the injection queue and then steals from randomly picked workers for a while
+  // before it parks. Pushes only wake a parked worker if nobody is searching already, and a
+  // searcher that finds work wakes the next one, so idle workers do not stampede.
+  class WorkStealingScheduler
+  {
+    struct alignas(64) Worker
+    {
+      WorkStealingDeque<TaskNode*> m_deque;
+      uint64_t m_seed = 0;
+      uint32_t m_ticks = 0;
+    };
+
+    // rounds of stealing before a worker parks
+    static constexpr int SEARCH_ROUNDS = 64;
+    // how often a busy worker looks at the injection queue first, so external work cannot starve
+    static constexpr uint32_t INJECTION_INTERVAL = 61;
+
+    static inline thread_local WorkerContext s_context;
+    static inline thread_local TaskNodeCache s_nodes;
+    // for threads outside the pool that steal while they wait
+    static inline thread_local uint64_t s_seed = 0x2545F4914F6CDD1Dull;
+
+  public:
+    WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+    WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+
+    explicit WorkStealingScheduler(size_t size)
+      : m_size{size ? size : 1}
+      , m_workers{new Worker[m_size]}
+      , m_injectedSize{0}
+      , m_searching{0}
+      , m_sleeping{0}
+      , m_epoch{0}
+      , m_stopping{false}
+    {
+    }
+
+    ~WorkStealingScheduler()
+    {
+      TaskNode* node = nullptr;
+      for (size_t i = 0; i != m_size; ++i)
+        while (m_workers[i].m_deque.Take(node))
+          delete node;
+    }
+
+    // binds the calling thread to worker index
+    void Attach(size_t index) noexcept
+    {
+      s_context = WorkerContext{this, index};
+      m_workers[index].m_seed = 0x9E3779B97F4A7C15ull * (index + 1);
+    }
+
+    void Push(work_t work)
+    {
+      if (s_context.m_scheduler == this)
+      {
+        m_workers[s_context.m_index].m_deque.Push(s_nodes.Acquire(std::move(work)));
+      }
+      else
+      {
+        std::lock_guard<std::mutex> lock{m_injectedMutex};
+        m_injected.emplace_back(std::move(work));
+        m_injectedSize.fetch_add(1, std::memory_order_relaxed);
+      }
+      Wake();
+    }
+
+    // blocks until there is work, false once the scheduler is stopped
+    bool Pop(size_t index, work_t& work)
+    {
+      Worker& self = m_workers[index];
+      while (!m_stopping.load(std::memory_order_acquire))
+      {
+        if (++self.m_ticks % INJECTION_INTERVAL == 0 && TryPopInjected(work))
+          return true;
+
+        TaskNode* node = nullptr;
+        if (self.m_deque.Take(node))
+          return Unwrap(node, work);
+
+        m_searching.fetch_add(1, std::memory_order_seq_cst);
+        for (int round = 0; round != SEARCH_ROUNDS; ++round)
+        {
+          if (TryPopInjected(work) || TrySteal(index, self.m_seed, work))
+          {
+            // the last searcher found work, so there may be more, let someone else look too
+            if (m_searching.fetch_sub(1, std::memory_order_seq_cst) == 1)
+              Wake();
+            return true;
+          }
+          if (m_stopping.load(std::memory_order_relaxed))
+            break;
+          std::this_thread::yield();
+        }
+        m_searching.fetch_sub(1, std::memory_order_seq_cst);
+
+        Park();
+      }
+      return false;
+    }
+
+    // never blocks, for threads that help out while they wait. A worker looks at its own
+    // deque first, any thread then takes from the injection queue or steals
+    bool TryPop(work_t& work)
+    {
+      TaskNode* node = nullptr;
+      if (s_context.m_scheduler == this)
+      {
+        Worker& self = m_workers[s_context.m_index];
+        if (self.m_deque.Take(node))
+          return Unwrap(node, work);
+        return TryPopInjected(work) || TrySteal(s_context.m_index, self.m_seed, work);
+      }
+      return TryPopInjected(work) || TrySteal(m_size, s_seed, work);
+    }
+
+    // true if nothing is waiting in the queue the calling thread posts to
+    bool LocalQueueEmpty() const noexcept
+    {
+      if (s_context.m_scheduler == this)
+        return m_workers[s_context.m_index].m_deque.Empty();
+      return !m_injectedSize.load(std::memory_order_relaxed);
+    }
+
+    void Stop()
+    {
+      {
+        std::lock_guard<std::mutex> lock{m_sleepMutex};
+        m_stopping.store(true, std::memory_order_release);
+      }
+      m_wake.notify_all();
+    }
+
+  private:
+    static bool Unwrap(TaskNode* node, work_t& work)
+    {
+      work = s_nodes.Release(node);
+      return true;
+    }
+
+    bool TryPopInjected(work_t& work)
+    {
+      if (!m_injectedSize.load(std::memory_order_relaxed))
+        return false;
+
+      std::lock_guard<std::mutex> lock{m_injectedMutex};
+      if (m_injected.empty())
+        return false;
+      work = std::move(m_injected.front());
+      m_injected.pop_front();
+      m_injectedSize.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    // tries every worker but self once, starting at a random one
+    bool TrySteal(size_t self, uint64_t& seed, work_t& work)
+    {
+      seed ^= seed << 13;
+      seed ^= seed >> 7;
+      seed ^= seed << 17;
+
+      const size_t start = seed % m_size;
+      for (size_t i = 0; i != m_size; ++i)
+      {
+        const size_t victim = start + i < m_size ? start + i : start + i - m_size;
+        TaskNode* node = nullptr;
+        if (victim != self && m_workers[victim].m_deque.Steal(node))
+          return Unwrap(node, work);
+      }
+      return false;
+    }
+
+    bool HasWork() const noexcept
+    {
+      if (m_injectedSize.load(std::memory_order_relaxed))
+        return true;
+      for (size_t i = 0; i != m_size; ++i)
+        if (!m_workers[i].m_deque.Empty())
+          return true;
+      return false;
+    }
+
+    void Park()
+    {
+      uint64_t epoch;
+      {
+        std::lock_guard<std::mutex> lock{m_sleepMutex};
+        epoch = m_epoch;
+      }
+
+      // pairs with the fence in Wake: either the pusher sees us sleeping or we see its work
+      m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!HasWork())
+      {
+        std::unique_lock<std::mutex> lock{m_sleepMutex};
+        m_wake.wait(lock, [this, epoch] { return m_epoch != epoch || m_stopping.load(std::memory_order_relaxed); });
+      }
+      m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void Wake()
+    {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (m_searching.load(std::memory_order_relaxed) || !m_sleeping.load(std::memory_order_relaxed))
+        return;
+
+      {
+        std::lock_guard<std::mutex> lock{m_sleepMutex};
+        ++m_epoch;
+      }
+      m_wake.notify_one();
+    }
+
+    const size_t m_size;
+    std::unique_ptr<Worker[]> m_workers;
+
+    std::mutex m_injectedMutex;
+    std::deque<work_t> m_injected;
+    alignas(64) std::atomic<size_t> m_injectedSize;
+
+    alignas(64) std::atomic<size_t> m_searching;
+    std::atomic<size_t> m_sleeping;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    uint64_t m_epoch;
+    std::atomic_bool m_stopping;
+  };
+
+  // defined in coroutine.hpp, which needs C++20
+  template <typename PoolT>
+  class ScheduleAwaitable;
+
 } // detail namespace
 
-  template <typename ThreadT = detail::NaiveThreadWrapper, typename WorkPolicyT = detail::DefaultWorkPolicy>
+  template <
+    typename ThreadT = detail::NaiveThreadWrapper,
+    typename WorkPolicyT = detail::DefaultWorkPolicy,
+    typename SchedulerT = detail::SharedQueueScheduler>
   class GenericThreadPool final : private WorkPolicyT
   {
   public:
@@ -74,22 +595,39 @@ namespace detail
     using thread_factory_t = std::function<ThreadT(worker_t)>;
     using thread_t = ThreadT;
 
-    GenericThreadPool(size_t size) noexcept;
+    // a size of 0 is clamped to 1 thread. Only nothrow when the scheduler is, the work stealing
+    // one allocates a deque per worker
+    GenericThreadPool(size_t size) noexcept(std::is_nothrow_constructible_v<SchedulerT, size_t>);
     template <typename ThreadFactoryT>
-    GenericThreadPool(size_t size, ThreadFactoryT&& threadFactory) noexcept;
+    GenericThreadPool(size_t size, ThreadFactoryT&& threadFactory) noexcept(std::is_nothrow_constructible_v<SchedulerT, size_t>);
     ~GenericThreadPool();
 
     void Start();
     void Stop();
     void Post(detail::work_t work);
 
+    // runs func(args...) on the pool, the callable, its arguments and the result share one allocation
+    template <typename FuncT, typename ... ArgsT>
+    Future<detail::submit_result_t<FuncT, ArgsT...>> Submit(FuncT&& func, ArgsT&& ... args);
+
+    // runs one queued task on the calling thread if there is any, so a thread that waits for
+    // the pool can help it instead. Works whether the pool was started or not
+    bool TryRunOne();
+
+    // true if nothing is waiting in the queue Post from the calling thread goes to
+    bool LocalQueueEmpty() const noexcept;
+
+    // co_await pool.Schedule() resumes the coroutine on a worker, see coroutine.hpp
+    detail::ScheduleAwaitable<GenericThreadPool> Schedule() noexcept
+    {
+      return detail::ScheduleAwaitable<GenericThreadPool>{*this};
+    }
+
   private:
-    void WorkerFunc();
+    void WorkerFunc(size_t index);
 
-    std::mutex m_mutex;
-    std::condition_variable m_condition;
-    std::atomic_bool m_stopping;
-    std::queue<detail::work_t> m_jobs;
+    // declared before the threads so it outlives them
+    SchedulerT m_scheduler;
     std::vector<ThreadT> m_threads;
     thread_factory_t m_threadFactory;
 
@@ -97,83 +635,97 @@ namespace detail
     std::once_flag m_init_flag, m_deinit_flag, m_ready_flag;
   };
 
-  template <typename ThreadT, typename WorkPolicyT>
-  GenericThreadPool<ThreadT, WorkPolicyT>::GenericThreadPool(size_t size) noexcept
+  template <typename ThreadT, typename WorkPolicyT, typename SchedulerT>
+  GenericThreadPool<ThreadT, WorkPolicyT, SchedulerT>::GenericThreadPool(size_t size) noexcept(std::is_nothrow_constructible_v<SchedulerT, size_t>)
     : GenericThreadPool{
         size,
         [](worker_t joinPool) { return ThreadT{std::move(joinPool)}; }}
   {
   }
 
-  template <typename ThreadT, typename WorkPolicyT>
+  template <typename ThreadT, typename WorkPolicyT, typename SchedulerT>
   template <typename ThreadFactoryT>
-  GenericThreadPool<ThreadT, WorkPolicyT>::GenericThreadPool(size_t size, ThreadFactoryT&& threadFactory) noexcept
-    : m_stopping{false}
+  GenericThreadPool<ThreadT, WorkPolicyT, SchedulerT>::GenericThreadPool(size_t size, ThreadFactoryT&& threadFactory) noexcept(std::is_nothrow_constructible_v<SchedulerT, size_t>)
+    : m_scheduler{size ? size : 1}
     , m_threadFactory{std::forward<ThreadFactoryT>(threadFactory)}
-    , m_poolSize{size}
+    , m_poolSize{size ? size : 1}
   {
     static_assert(std::is_same_v<ThreadT, std::result_of_t<ThreadFactoryT(std::function<void()>)>>);
   }
 
-  template <typename ThreadT, typename WorkPolicyT>
-  GenericThreadPool<ThreadT, WorkPolicyT>::~GenericThreadPool()
+  template <typename ThreadT, typename WorkPolicyT, typename SchedulerT>
+  GenericThreadPool<ThreadT, WorkPolicyT, SchedulerT>::~GenericThreadPool()
   {
     Stop();
   }
 
-  template <typename ThreadT, typename WorkPolicyT>
-  void GenericThreadPool<ThreadT, WorkPolicyT>::Start()
+  template <typename ThreadT, typename WorkPolicyT, typename SchedulerT>
+  void GenericThreadPool<ThreadT, WorkPolicyT, SchedulerT>::Start()
   {
     std::call_once(
       m_init_flag,
       [this] ()
       {
-        m_threads.resize(m_poolSize);
+        m_threads.reserve(m_poolSize);
         for (size_t i = 0; i != m_poolSize; ++i)
-          m_threads.emplace_back(m_threadFactory([this] { WorkerFunc(); }));
+          m_threads.emplace_back(m_threadFactory([this, i] { WorkerFunc(i); }));
       });
   }
 
-  template <typename ThreadT, typename WorkPolicyT>
-  void GenericThreadPool<ThreadT, WorkPolicyT>::Stop()
+  template <typename ThreadT, typename WorkPolicyT, typename SchedulerT>
+  void GenericThreadPool<ThreadT, WorkPolicyT, SchedulerT>::Stop()
   {
     std::call_once(
       m_deinit_flag,
       [this] ()
       {
-        m_stopping = true;
-        m_condition.notify_all();
-
+        m_scheduler.Stop();
         m_threads.clear();
       });
   }
 
-  template <typename ThreadT, typename WorkPolicyT>
-  void GenericThreadPool<ThreadT, WorkPolicyT>::Post(detail::work_t work)
+  template <typename ThreadT, typename WorkPolicyT, typename SchedulerT>
+  void GenericThreadPool<ThreadT, WorkPolicyT, SchedulerT>::Post(detail::work_t work)
   {
-    {
-      std::lock_guard<std::mutex> lock{m_mutex};
-      m_jobs.emplace(std::move(work));
-    }
-    m_condition.notify_one();
+    m_scheduler.Push(std::move(work));
   }
 
-  template <typename ThreadT, typename WorkPolicyT>
-  void GenericThreadPool<ThreadT, WorkPolicyT>::WorkerFunc()
+  template <typename ThreadT, typename WorkPolicyT, typename SchedulerT>
+  template <typename FuncT, typename ... ArgsT>
+  Future<detail::submit_result_t<FuncT, ArgsT...>> GenericThreadPool<ThreadT, WorkPolicyT, SchedulerT>::Submit(
+    FuncT&& func, ArgsT&& ... args)
   {
-    while (!m_stopping)
-    {
-      detail::work_t work;
-      {
-        std::unique_lock<std::mutex> lock{m_mutex};
-        m_condition.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+    auto [task, future] = detail::MakeSubmission(std::forward<FuncT>(func), std::forward<ArgsT>(args)...);
+    Post(std::move(task));
+    return std::move(future);
+  }
 
-        if (m_stopping)
-          break;
+  template <typename ThreadT, typename WorkPolicyT, typename SchedulerT>
+  bool GenericThreadPool<ThreadT, WorkPolicyT, SchedulerT>::TryRunOne()
+  {
+    detail::work_t work;
+    if (!m_scheduler.TryPop(work))
+      return false;
 
-        work = m_jobs.front();
-        m_jobs.pop();
-      }
+    WorkPolicyT::BeginWork(work);
+    return true;
+  }
+
+  template <typename ThreadT, typename WorkPolicyT, typename SchedulerT>
+  bool GenericThreadPool<ThreadT, WorkPolicyT, SchedulerT>::LocalQueueEmpty() const noexcept
+  {
+    return m_scheduler.LocalQueueEmpty();
+  }
+
+  template <typename ThreadT, typename WorkPolicyT, typename SchedulerT>
+  void GenericThreadPool<ThreadT, WorkPolicyT, SchedulerT>::WorkerFunc(size_t index)
+  {
+    m_scheduler.Attach(index);
+    for (;;)
+    {
+      detail::work_t work;
+      if (!m_scheduler.Pop(index, work))
+        break;
 
       WorkPolicyT::BeginWork(work);
     }
@@ -181,7 +733,11 @@ namespace detail
 
   // Class Template Argument Deduction (CTAD)
   // https://en.cppreference.com/w/cpp/language/class_template_argument_deduction
-  template <typename ThreadT, typename WorkPolicyT>
-  GenericThreadPool(size_t) -> GenericThreadPool<ThreadT, WorkPolicyT>;
+  template <typename ThreadT, typename WorkPolicyT, typename SchedulerT>
+  GenericThreadPool(size_t) -> GenericThreadPool<ThreadT, WorkPolicyT, SchedulerT>;
+
+  // one deque per worker instead of one locked queue, for many cores and fine grained work
+  using WorkStealingThreadPool = GenericThreadPool<
+    detail::NaiveThreadWrapper, detail::DefaultWorkPolicy, detail::WorkStealingScheduler>;
 
 } // namespace regit::async
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <containers/circular_buffer/include/circular_buffer.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace regit::containers {
+
+// What a push does when the buffer is full
+enum class OverflowPolicy
+{
+  Overwrite,  // drop the oldest element, like CircularBuffer::push
+  Reject,     // fail the push and leave the buffer untouched
+  Block       // wait until a consumer makes room (or the timeout expires)
+};
+
+namespace detail
+{
+  // spins for a short while before the caller falls back to sleeping on a condition variable,
+  // a consumer that is just behind usually catches up well within the spin
+  template <typename PredicateT>
+  bool SpinUntil(PredicateT&& ready) noexcept
+  {
+    for (unsigned attempt = 0; attempt != 256; ++attempt)
+    {
+      if (ready())
+        return true;
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#else
+      std::this_thread::yield();
+#endif
+    }
+    return ready();
+  }
+
+} // detail namespace
+
+// Thread-safe bounded FIFO over a CircularBuffer for any number of producers and consumers.
+// Policy decides what a push does when the buffer is full; consumers always wait for data.
+// Waiting threads spin briefly on a lock-free snapshot of the size and then park on a
+// condition variable, which is only notified while somebody is actually parked.
+template <typename T, OverflowPolicy Policy = OverflowPolicy::Block, typename Allocator = std::allocator<T>>
+class BlockingCircularBuffer
+{
+  using clock_t = std::chrono::steady_clock;
+
+  mutable std::mutex mMutex;
+  std::condition_variable mNotEmpty;
+  std::condition_variable mNotFull;
+  CircularBuffer<T, Allocator> mBuffer;
+  // mirror of mBuffer.size(), written under the lock, read without it while spinning
+  std::atomic<size_t> mSize;
+  std::atomic<bool> mClosed;
+  size_t mWaitingProducers;
+  size_t mWaitingConsumers;
+
+  template <typename ... Args>
+  bool EmplaceUntil(const clock_t::time_point* deadline, Args&& ... args)
+  {
+    if constexpr (Policy == OverflowPolicy::Block)
+      detail::SpinUntil([this] {
+        return mSize.load(std::memory_order_relaxed) != mBuffer.capacity() || mClosed.load(std::memory_order_relaxed);
+      });
+
+    std::unique_lock<std::mutex> lock{ mMutex };
+    if (mClosed.load(std::memory_order_relaxed))
+      return false;
+
+    if (mBuffer.full())
+    {
+      if constexpr (Policy == OverflowPolicy::Reject)
+        return false;
+      else if constexpr (Policy == OverflowPolicy::Block)
+      {
+        auto ready = [this] { return !mBuffer.full() || mClosed.load(std::memory_order_relaxed); };
+        ++mWaitingProducers;
+        bool woken = true;
+        if (deadline)
+          woken = mNotFull.wait_until(lock, *deadline, ready);
+        else
+          mNotFull.wait(lock, ready);
+        --mWaitingProducers;
+        if (!woken || mClosed.load(std::memory_order_relaxed))
+          return false;
+      }
+    }
+
+    mBuffer.emplace(std::forward<Args>(args)...);
+    mSize.store(mBuffer.size(), std::memory_order_relaxed);
+    const bool wake = mWaitingConsumers != 0;
+    lock.unlock();
+    if (wake)
+      mNotEmpty.notify_one();
+    return true;
+  }
+
+  bool PopUntil(T& value, const clock_t::time_point* deadline, bool wait)
+  {
+    if (wait)
+      detail::SpinUntil([this] {
+        return mSize.load(std::memory_order_relaxed) != 0 || mClosed.load(std::memory_order_relaxed);
+      });
+
+    std::unique_lock<std::mutex> lock{ mMutex };
+    if (mBuffer.empty() && wait)
+    {
+      auto ready = [this] { return !mBuffer.empty() || mClosed.load(std::memory_order_relaxed); };
+      ++mWaitingConsumers;
+      if (deadline)
+        mNotEmpty.wait_until(lock, *deadline, ready);
+      else
+        mNotEmpty.wait(lock, ready);
+      --mWaitingConsumers;
+    }
+    // a closed buffer still hands out what is left in it
+    if (mBuffer.empty())
+      return false;
+
+    value = std::move(mBuffer.front());
+    mBuffer.pop_front();
+    mSize.store(mBuffer.size(), std::memory_order_relaxed);
+    const bool wake = mWaitingProducers != 0;
+    lock.unlock();
+    if (wake)
+      mNotFull.notify_one();
+    return true;
+  }
+
+public:
+  explicit BlockingCircularBuffer(size_t size = 1)
+    : mMutex{ }, mNotEmpty{ }, mNotFull{ }, mBuffer(size), mSize{ 0 }, mClosed{ false },
+      mWaitingProducers{ 0 }, mWaitingConsumers{ 0 }
+  { }
+
+  BlockingCircularBuffer(const BlockingCircularBuffer&) = delete;
+  BlockingCircularBuffer& operator=(const BlockingCircularBuffer&) = delete;
+
+  // Overwrite: always succeeds. Reject: false if the buffer is full.
+  // Block: waits for room. All of them return false once the buffer is closed.
+  bool push(const T& value)
+  {
+    return EmplaceUntil(nullptr, value);
+  }
+
+  bool push(T&& value)
+  {
+    return EmplaceUntil(nullptr, std::move(value));
+  }
+
+  template <typename ... Args>
+  bool emplace(Args&& ... args)
+  {
+    return EmplaceUntil(nullptr, std::forward<Args>(args)...);
+  }
+
+  // like push, but a blocking push gives up after timeout
+  template <typename Rep, typename Period>
+  bool push_for(const T& value, std::chrono::duration<Rep, Period> timeout)
+  {
+    const auto deadline = clock_t::now() + timeout;
+    return EmplaceUntil(&deadline, value);
+  }
+
+  template <typename Rep, typename Period>
+  bool push_for(T&& value, std::chrono::duration<Rep, Period> timeout)
+  {
+    const auto deadline = clock_t::now() + timeout;
+    return EmplaceUntil(&deadline, std::move(value));
+  }
+
+  // takes the oldest element without waiting
+  bool try_pop(T& value)
+  {
+    return PopUntil(value, nullptr, false);
+  }
+
+  // waits for an element; returns false only once the buffer is closed and drained
+  bool pop(T& value)
+  {
+    return PopUntil(value, nullptr, true);
+  }
+
+  // returns false if nothing arrived before the timeout
+  template <typename Rep, typename Period>
+  bool pop_for(T& value, std::chrono::duration<Rep, Period> timeout)
+  {
+    const auto deadline = clock_t::now() + timeout;
+    return PopUntil(value, &deadline, true);
+  }
+
+  // rejects every further push and wakes up every waiting thread, used for shutdown;
+  // consumers still drain the elements left in the buffer
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mClosed.store(true, std::memory_order_relaxed);
+    }
+    mNotEmpty.notify_all();
+    mNotFull.notify_all();
+  }
+
+  bool closed() const noexcept
+  {
+    return mClosed.load(std::memory_order_relaxed);
+  }
+
+  size_t size() const noexcept
+  {
+    return mSize.load(std::memory_order_relaxed);
+  }
+
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  size_t capacity() const noexcept
+  {
+    return mBuffer.capacity();
+  }
+};
+
+}
@@ -1,265 +1,582 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <cstddef>
 #include <cstring>
 #include <iterator>
 #include <initializer_list>
+#include <numeric>
+#include <stdexcept>
 #include <tuple>
+#include <type_traits>
 
 namespace regit::containers {
 
-template <typename T, typename Allocator = std::allocator<T>>
-class CircularBuffer
+// Non-owning view over a contiguous run of elements
+template <typename T>
+class Span
 {
-  static constexpr unsigned char INVALID = 0xCC;
+  T* mData;
+  size_t mSize;
 
-  Allocator mAlloc;
+public:
+  constexpr Span() noexcept
+    : mData{ nullptr }, mSize{ 0 }
+  { }
+
+  constexpr Span(T* data, size_t size) noexcept
+    : mData{ data }, mSize{ size }
+  { }
+
+  constexpr T* data() const noexcept
+  {
+    return mData;
+  }
+
+  constexpr size_t size() const noexcept
+  {
+    return mSize;
+  }
+
+  constexpr size_t size_bytes() const noexcept
+  {
+    return mSize * sizeof(T);
+  }
+
+  constexpr bool empty() const noexcept
+  {
+    return mSize == 0;
+  }
+
+  constexpr T& operator[](size_t index) const noexcept
+  {
+    return mData[index];
+  }
+
+  constexpr T* begin() const noexcept
+  {
+    return mData;
+  }
+
+  constexpr T* end() const noexcept
+  {
+    return mData + mSize;
+  }
+};
+
+// Walks a CircularBuffer from its oldest to its newest element.
+// The position is kept unwrapped (it may run past the end of the storage by up to one
+// capacity), which makes comparisons plain integer compares and lets segments() split
+// any range into at most two contiguous runs.
+template <typename T1>
+class CircularBufferIterator
+{
+  template <typename T2>
+  friend class CircularBufferIterator;
+
+  T1* mBuffer;
   size_t mCap;
-  T* mBuffer;
-  T* mStart, *mEnd;
+  size_t mPos;
 
 public:
+  using iterator_category = std::random_access_iterator_tag;
+  using difference_type = std::ptrdiff_t;
+  using value_type = std::remove_const_t<T1>;
+  using pointer = T1*;
+  using reference = T1&;
 
-  template <typename T1>
-  class Iterator
+  CircularBufferIterator() noexcept
+    : mBuffer{ nullptr }, mCap{ 0 }, mPos{ 0 }
+  { }
+
+  CircularBufferIterator(T1* buffer, size_t cap, size_t pos) noexcept
+    : mBuffer{ buffer }, mCap{ cap }, mPos{ pos }
+  { }
+
+  // iterator to const_iterator
+  template <typename T2, typename = std::enable_if_t<std::is_convertible_v<T2*, T1*>>>
+  CircularBufferIterator(const CircularBufferIterator<T2>& rhs) noexcept
+    : mBuffer{ rhs.mBuffer }, mCap{ rhs.mCap }, mPos{ rhs.mPos }
+  { }
+
+  T1* buffer() const noexcept
   {
-    T1* mIter;
+    return mBuffer;
+  }
 
-  public:
-    using iterator_category = std::random_access_iterator_tag;
-    using difference_type = std::ptrdiff_t;
-    using value_type = T1;
-    using pointer = typename std::remove_reference<T1>::type*;
-    using reference = typename std::remove_reference<T1>::type&;
+  size_t capacity() const noexcept
+  {
+    return mCap;
+  }
 
-    Iterator(T1 *iter) noexcept
-      : mIter{ iter }
-    { }
+  size_t position() const noexcept
+  {
+    return mPos;
+  }
 
-    reference operator*() noexcept
-    {
-      return *mIter;
-    }
+  pointer get() const noexcept
+  {
+    return mBuffer + (mPos < mCap ? mPos : mPos - mCap);
+  }
 
-    value_type operator*() const noexcept
-    {
-      return *mIter;
-    }
+  reference operator*() const noexcept
+  {
+    return *get();
+  }
 
-    pointer operator->() const noexcept
-    {
-      return mIter;
-    }
+  pointer operator->() const noexcept
+  {
+    return get();
+  }
 
-    bool operator==(const Iterator& rhs) const noexcept
-    {
-      return mIter == rhs.mIter;
-    }
+  reference operator[](difference_type pos) const noexcept
+  {
+    return *(*this + pos);
+  }
 
-    bool operator!=(const Iterator& rhs) const noexcept
-    {
-      return !operator==(rhs);
-    }
+  bool operator==(const CircularBufferIterator& rhs) const noexcept
+  {
+    return mPos == rhs.mPos;
+  }
 
-    Iterator& operator++() noexcept
-    {
-      ++mIter; return *this;
-    }
+  bool operator!=(const CircularBufferIterator& rhs) const noexcept
+  {
+    return !operator==(rhs);
+  }
 
-    Iterator operator++(int) noexcept
-    {
-      Iterator tmp{ *this };
-      ++mIter;
-      return tmp;
-    }
+  bool operator<(const CircularBufferIterator& rhs) const noexcept
+  {
+    return mPos < rhs.mPos;
+  }
 
-    Iterator& operator--() noexcept
-    {
-      --mIter;
-      return *this;
-    }
+  bool operator>(const CircularBufferIterator& rhs) const noexcept
+  {
+    return rhs < *this;
+  }
 
-    Iterator operator--(int) noexcept
-    {
-      Iterator tmp{ *this };
-      --mIter;
-      return tmp;
-    }
+  bool operator<=(const CircularBufferIterator& rhs) const noexcept
+  {
+    return !(rhs < *this);
+  }
 
-    Iterator operator+(size_t pos) const noexcept
-    {
-      return mIter + pos;
-    }
+  bool operator>=(const CircularBufferIterator& rhs) const noexcept
+  {
+    return !(*this < rhs);
+  }
 
-    difference_type operator-(const Iterator& rhs) const noexcept
-    {
-      return mIter - rhs.mIter;
-    }
+  CircularBufferIterator& operator++() noexcept
+  {
+    ++mPos;
+    return *this;
+  }
 
-    Iterator operator-(size_t pos) const noexcept
-    {
-      return mIter - pos;
-    }
-  };
+  CircularBufferIterator operator++(int) noexcept
+  {
+    CircularBufferIterator tmp{ *this };
+    ++mPos;
+    return tmp;
+  }
 
-  template <typename T1>
-  class ReverseIterator
+  CircularBufferIterator& operator--() noexcept
   {
-    T1* mCurr, *mPrev;
+    --mPos;
+    return *this;
+  }
 
-  public:
-    using iterator_category = std::random_access_iterator_tag;
-    using difference_type = std::ptrdiff_t;
-    using value_type = T1;
-    using pointer = typename std::remove_reference<T1>::type*;
-    using reference = typename std::remove_reference<T1>::type&;
+  CircularBufferIterator operator--(int) noexcept
+  {
+    CircularBufferIterator tmp{ *this };
+    --mPos;
+    return tmp;
+  }
 
-    ReverseIterator(T1 *iter) noexcept
-      : mCurr{ iter }, mPrev{ std::prev(iter) }
-    { }
+  CircularBufferIterator& operator+=(difference_type pos) noexcept
+  {
+    mPos += pos;
+    return *this;
+  }
 
-    reference operator*() noexcept
-    {
-      return *mPrev;
-    }
+  CircularBufferIterator& operator-=(difference_type pos) noexcept
+  {
+    mPos -= pos;
+    return *this;
+  }
 
-    value_type operator*() const noexcept
-    {
-      return *mPrev;
-    }
+  CircularBufferIterator operator+(difference_type pos) const noexcept
+  {
+    return { mBuffer, mCap, mPos + pos };
+  }
 
-    pointer operator->() const noexcept
-    {
-      return mPrev;
-    }
+  friend CircularBufferIterator operator+(difference_type pos, const CircularBufferIterator& iter) noexcept
+  {
+    return iter + pos;
+  }
 
-    bool operator==(const ReverseIterator& rhs) const noexcept
-    {
-      return std::tie(mCurr, mPrev) == std::tie(rhs.mCurr, rhs.mPrev);
-    }
+  CircularBufferIterator operator-(difference_type pos) const noexcept
+  {
+    return { mBuffer, mCap, mPos - pos };
+  }
 
-    bool operator!=(const ReverseIterator& rhs) const noexcept
-    {
-      return !operator==(rhs);
-    }
+  difference_type operator-(const CircularBufferIterator& rhs) const noexcept
+  {
+    return static_cast<difference_type>(mPos - rhs.mPos);
+  }
+};
+
+// Splits [first, last) into the (at most two) contiguous runs of storage it covers
+template <typename T1>
+std::pair<Span<T1>, Span<T1>> segments(CircularBufferIterator<T1> first, CircularBufferIterator<T1> last) noexcept
+{
+  T1* buffer = first.buffer();
+  size_t cap = first.capacity();
+  size_t begin = first.position(), end = last.position();
+
+  if (begin >= cap)
+    return { { buffer + begin - cap, end - begin }, { } };
+  if (end <= cap)
+    return { { buffer + begin, end - begin }, { } };
+  return { { buffer + begin, cap - begin }, { buffer, end - cap } };
+}
 
-    ReverseIterator& operator++() noexcept
+// Types whose objects can be moved to another address with a plain memcpy (and without
+// running the destructor on the source). Specialise it for types such as std::unique_ptr
+// to let CircularBuffer relocate them in bulk.
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T>
+{ };
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+namespace detail
+{
+  // allocators may provide T* reallocate(T* buffer, size_t count, size_t newCount), which
+  // resizes the allocation keeping its bytes and returns nullptr if it cannot do so
+  template <typename AllocatorT, typename = void>
+  struct has_reallocate : std::false_type
+  { };
+
+  template <typename AllocatorT>
+  struct has_reallocate<AllocatorT, std::void_t<decltype(std::declval<AllocatorT&>().reallocate(
+    std::declval<typename AllocatorT::value_type*>(), size_t{ }, size_t{ }))>> : std::true_type
+  { };
+
+  template <typename AllocatorT, typename PointerT, typename ArgsList, typename = void>
+  struct has_construct : std::false_type
+  { };
+
+  template <typename AllocatorT, typename PointerT, typename ... Args>
+  struct has_construct<AllocatorT, PointerT, std::tuple<Args...>, std::void_t<decltype(std::declval<AllocatorT&>().construct(
+    std::declval<PointerT>(), std::declval<Args>()...))>> : std::true_type
+  { };
+
+} // detail namespace
+
+template <typename T, typename Allocator = std::allocator<T>>
+class CircularBuffer
+{
+  using alloc_traits = std::allocator_traits<Allocator>;
+
+  Allocator mAlloc;
+  size_t mCap;
+  T* mBuffer;
+  // mStart is the oldest element and mEnd the newest one; both point at mStart when empty
+  T* mStart, *mEnd;
+  size_t mSize;
+
+  T* Allocate(size_t count)
+  {
+    return alloc_traits::allocate(mAlloc, count);
+  }
+
+  void Deallocate(T* buffer, size_t count) noexcept
+  {
+    if (buffer)
+      alloc_traits::deallocate(mAlloc, buffer, count);
+  }
+
+  // copies and moves go through the allocator like the standard containers do
+  template <typename ... Args>
+  void Construct(T* slot, Args&& ... args)
+  {
+    alloc_traits::construct(mAlloc, slot, std::forward<Args>(args)...);
+  }
+
+  // emplace brace initialises, so emplace(2, 5) on a CircularBuffer<std::vector<int>> stores
+  // { 2, 5 }; only allocators with their own construct get the arguments passed on instead
+  // (std::allocator still declares one in C++17, it is plain placement new)
+  template <typename ... Args>
+  void ConstructEmplaced(T* slot, Args&& ... args)
+  {
+    if constexpr (!std::is_same_v<Allocator, std::allocator<T>>
+      && detail::has_construct<Allocator, T*, std::tuple<Args&&...>>::value)
+      alloc_traits::construct(mAlloc, slot, std::forward<Args>(args)...);
+    else
+      ::new (static_cast<void*>(slot)) T{ std::forward<Args>(args)... };
+  }
+
+  void Destroy(T* slot) noexcept
+  {
+    alloc_traits::destroy(mAlloc, slot);
+  }
+
+  // exchanges the storage (not the allocators) with rhs
+  void SwapStorage(CircularBuffer& rhs) noexcept
+  {
+    std::swap(mBuffer, rhs.mBuffer);
+    std::swap(mCap, rhs.mCap);
+    std::swap(mStart, rhs.mStart);
+    std::swap(mEnd, rhs.mEnd);
+    std::swap(mSize, rhs.mSize);
+  }
+
+  T* next(T* iter) const noexcept
+  {
+    return std::next(iter) == mBuffer + mCap ? mBuffer : std::next(iter);
+  }
+
+  T* prev(T* iter) const noexcept
+  {
+    return iter == mBuffer ? mBuffer + mCap - 1 : std::prev(iter);
+  }
+
+  // count must not exceed mCap
+  T* advance(T* iter, size_t count) const noexcept
+  {
+    size_t offset = static_cast<size_t>(iter - mBuffer) + count;
+    return mBuffer + (offset >= mCap ? offset - mCap : offset);
+  }
+
+  // raw pointers to T can be block copied when T is trivially copyable
+  template <typename PointerT>
+  static constexpr bool is_memcpy_compatible_v = std::is_trivially_copyable_v<T>
+    && std::is_pointer_v<PointerT>
+    && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<PointerT>>, T>;
+
+  template <typename ForwardIt>
+  void construct_segment(T* dest, ForwardIt& first, size_t count)
+  {
+    if (!count)
+      return;
+
+    if constexpr (is_memcpy_compatible_v<ForwardIt>)
     {
-      mCurr = mPrev;
-      mPrev = std::prev(mPrev);
-      return *this;
+      memcpy(dest, first, sizeof(T) * count);
+      first += count;
+      mEnd = dest + count - 1;
+      mSize += count;
     }
-
-    ReverseIterator operator++(int) noexcept
+    else
     {
-      ReverseIterator tmp{ *this };
-      ++*this;
-      return tmp;
+      for (T* last = dest + count; dest != last; ++dest, ++first)
+      {
+        Construct(dest, *first);
+        mEnd = dest;
+        ++mSize;
+      }
     }
+  }
 
-    ReverseIterator& operator--() noexcept
+  // copies (const SourceT) or moves the elements of rhs, oldest first, into the empty storage;
+  // only used by constructors, so a throwing element constructor releases the storage as well
+  template <typename SourceT>
+  void construct_from(SourceT& rhs)
+  {
+    try
     {
-      mPrev = mCurr;
-      mCurr = std::next(mCurr);
-      return *this;
+      for (auto span : { rhs.array_one(), rhs.array_two() })
+      {
+        if constexpr (std::is_const_v<SourceT> || std::is_trivially_copyable_v<T>)
+        {
+          const T* src = span.data();
+          construct_segment(mBuffer + mSize, src, span.size());
+        }
+        else
+        {
+          std::move_iterator<T*> src{ span.data() };
+          construct_segment(mBuffer + mSize, src, span.size());
+        }
+      }
     }
-
-    ReverseIterator operator--(int) noexcept
+    catch (...)
     {
-      ReverseIterator tmp{ *this };
-      --*this;
-      return tmp;
+      clear();
+      Deallocate(mBuffer, mCap);
+      throw;
     }
+  }
 
-    ReverseIterator operator+(size_t pos) const noexcept
+  // moves the kept elements starting at from into dest, oldest first, and ends their
+  // lifetime in the old storage; the elements before from are left alone
+  void relocate(T* dest, T* from, size_t kept)
+  {
+    size_t first = static_cast<size_t>(mBuffer + mCap - from);
+    if (first > kept)
+      first = kept;
+
+    if constexpr (is_trivially_relocatable_v<T>)
     {
-      ReverseIterator tmp{ *this };
-      tmp.mCurr = tmp.mCurr - pos;
-      tmp.mPrev = std::prev(tmp.mCurr);
-      return tmp;
+      memcpy(static_cast<void*>(dest), from, sizeof(T) * first);
+      memcpy(static_cast<void*>(dest + first), mBuffer, sizeof(T) * (kept - first));
     }
-
-    ReverseIterator operator-(size_t pos) const noexcept
+    else
     {
-      ReverseIterator tmp{ *this };
-      tmp.mCurr = tmp.mCurr + pos;
-      tmp.mPrev = std::prev(tmp.mCurr);
-      return tmp;
+      // the old elements are only destroyed once every one of them made it across
+      size_t constructed = 0;
+      try
+      {
+        for (T* src = from; constructed != kept; ++constructed, src = next(src))
+          Construct(dest + constructed, std::move_if_noexcept(*src));
+      }
+      catch (...)
+      {
+        while (constructed)
+          Destroy(dest + --constructed);
+        throw;
+      }
+
+      for (T* src = from; constructed; --constructed, src = next(src))
+        Destroy(src);
     }
+  }
+
+  // grows the storage through the allocator's reallocate hook (mremap for mapped storage),
+  // appending the wrapped elements behind the others so the contents end up as one run
+  bool grow_in_place(size_t sz)
+  {
+    size_t first = static_cast<size_t>(mBuffer + mCap - mStart);
+    if (first > mSize)
+      first = mSize;
+    size_t second = mSize - first;
+    if (sz - mCap < second)
+      return false;
+
+    size_t start_pos = static_cast<size_t>(mStart - mBuffer);
+    T* grown = mAlloc.reallocate(mBuffer, mCap, sz);
+    if (!grown)
+      return false;
+
+    mBuffer = grown;
+    mStart = mBuffer + start_pos;
+    memcpy(static_cast<void*>(mBuffer + mCap), mBuffer, sizeof(T) * second);
+    mCap = sz;
+    mEnd = mSize ? mStart + mSize - 1 : mStart;
+    return true;
+  }
 
-    difference_type operator-(const ReverseIterator& rhs) const noexcept
+  template <typename OutputIt>
+  void move_segment(T* src, size_t count, OutputIt& out)
+  {
+    if constexpr (is_memcpy_compatible_v<OutputIt>)
     {
-      return mCurr - rhs.mCurr;
+      memcpy(out, src, sizeof(T) * count);
+      out += count;
     }
-
-    Iterator<T1> base() const noexcept
+    else
     {
-      return mCurr;
+      for (T* last = src + count; src != last; ++src, ++out)
+      {
+        *out = std::move(*src);
+        Destroy(src);
+      }
     }
-  };
-
-  explicit CircularBuffer(size_t size = 1)
-    : mAlloc{ }, mCap{ size }, mBuffer{ mAlloc.allocate(size) },
-      mStart{ mBuffer }, mEnd{ mStart }
-  {
-    memset(mBuffer, INVALID, sizeof(T) * mCap);
   }
 
+public:
+
+  template <typename T1>
+  using Iterator = CircularBufferIterator<T1>;
+
+  template <typename T1>
+  using ReverseIterator = std::reverse_iterator<CircularBufferIterator<T1>>;
+
+  explicit CircularBuffer(size_t size = 1, const Allocator& alloc = Allocator())
+    : mAlloc{ alloc }, mCap{ size }, mBuffer{ Allocate(size) },
+      mStart{ mBuffer }, mEnd{ mStart }, mSize{ 0 }
+  { }
+
   CircularBuffer(const CircularBuffer& rhs)
-    : mAlloc{ rhs.mAlloc }, mCap{ rhs.mCap }, mBuffer{ mAlloc.allocate(rhs.mCap) },
-      mStart{ mBuffer + (rhs.mStart - rhs.mBuffer) }, mEnd{ mBuffer + (rhs.mEnd - rhs.mBuffer) }
+    : CircularBuffer{ rhs, alloc_traits::select_on_container_copy_construction(rhs.mAlloc) }
+  { }
+
+  // the copy is linearised: its oldest element sits at the start of the storage
+  CircularBuffer(const CircularBuffer& rhs, const Allocator& alloc)
+    : mAlloc{ alloc }, mCap{ rhs.mCap }, mBuffer{ Allocate(rhs.mCap) },
+      mStart{ mBuffer }, mEnd{ mBuffer }, mSize{ 0 }
   {
-    memcpy(mBuffer, rhs.mBuffer, sizeof(T) * rhs.mCap);
+    construct_from(rhs);
   }
 
   CircularBuffer(CircularBuffer&& rhs) noexcept
-    : mAlloc{ rhs.mAlloc }, mCap{ rhs.mCap }, mBuffer{ rhs.mBuffer },
-      mStart{ rhs.mStart }, mEnd{ rhs.mEnd }
+    : mAlloc{ std::move(rhs.mAlloc) }, mCap{ rhs.mCap }, mBuffer{ rhs.mBuffer },
+      mStart{ rhs.mStart }, mEnd{ rhs.mEnd }, mSize{ rhs.mSize }
   {
     rhs.mStart = nullptr;
     rhs.mEnd = nullptr;
+    rhs.mSize = 0;
     rhs.mCap = 0;
     rhs.mBuffer = nullptr;
   }
 
+  // steals the storage if alloc can free it, moves the elements into storage from alloc otherwise
+  CircularBuffer(CircularBuffer&& rhs, const Allocator& alloc)
+    : mAlloc{ alloc }, mCap{ 0 }, mBuffer{ nullptr }, mStart{ nullptr }, mEnd{ nullptr }, mSize{ 0 }
+  {
+    if (alloc_traits::is_always_equal::value || mAlloc == rhs.mAlloc)
+      SwapStorage(rhs);
+    else
+    {
+      mCap = rhs.mCap;
+      mBuffer = Allocate(mCap);
+      mStart = mEnd = mBuffer;
+      construct_from(rhs);
+    }
+  }
+
   template <typename InputIt>
-  CircularBuffer(InputIt _begin, InputIt _end)
-    : mAlloc{ }, mCap{ static_cast<size_t>(_end - _begin) },
-      mBuffer{ mAlloc.allocate(mCap) }, mStart{ mBuffer }, mEnd{ mBuffer + mCap - 1 }
+  CircularBuffer(InputIt _begin, InputIt _end, const Allocator& alloc = Allocator())
+    : mAlloc{ alloc }, mCap{ static_cast<size_t>(_end - _begin) },
+      mBuffer{ Allocate(mCap) }, mStart{ mBuffer }, mEnd{ mBuffer + mCap - 1 }, mSize{ mCap }
   {
     std::uninitialized_copy(_begin, _end, mBuffer);
   }
 
-  CircularBuffer(std::initializer_list<T> il)
-    : CircularBuffer{ il.begin(), il.end() }
+  CircularBuffer(std::initializer_list<T> il, const Allocator& alloc = Allocator())
+    : CircularBuffer{ il.begin(), il.end(), alloc }
   { }
 
   CircularBuffer& operator=(const CircularBuffer& rhs)
   {
-    Allocator tmpAlloc = rhs.mAlloc;
-    T* tmp = mAlloc.allocate(rhs.mCap);
-    memcpy(tmp, rhs.mBuffer, sizeof(T) * rhs.mCap);
-    size_t start_pos = mBuffer - mStart;
-    size_t end_pos = mBuffer - mEnd;
-    mAlloc.deallocate(mBuffer, mCap);
+    if (this == &rhs)
+      return *this;
 
-    mAlloc = rhs.mAlloc;
-    mBuffer = tmp;
-    mStart = mBuffer + start_pos;
-    mEnd = mBuffer + end_pos;
-    mCap = rhs.mCap;
+    // the new storage has to come from the allocator that owns it afterwards;
+    // nothing changes if copying an element throws
+    CircularBuffer tmp{ rhs, alloc_traits::propagate_on_container_copy_assignment::value ? rhs.mAlloc : mAlloc };
+    SwapStorage(tmp);
+    std::swap(mAlloc, tmp.mAlloc);
 
     return *this;
   }
 
-  CircularBuffer& operator=(CircularBuffer&& rhs) noexcept
+  CircularBuffer& operator=(CircularBuffer&& rhs)
+    noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)
   {
-    std::swap(mBuffer, rhs.mBuffer);
-    std::swap(mCap, rhs.mCap);
-    std::swap(mStart, rhs.mStart);
-    std::swap(mEnd, rhs.mEnd);
-    std::swap(mAlloc, rhs.mAlloc);
+    if constexpr (!alloc_traits::propagate_on_container_move_assignment::value)
+    {
+      // storage from an unequal allocator cannot be adopted, move the elements instead
+      if (!alloc_traits::is_always_equal::value && mAlloc != rhs.mAlloc)
+      {
+        CircularBuffer tmp{ std::move(rhs), mAlloc };
+        SwapStorage(tmp);
+        return *this;
+      }
+    }
+
+    SwapStorage(rhs);
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+      std::swap(mAlloc, rhs.mAlloc);
 
     return *this;
   }
@@ -267,67 +584,83 @@ public:
   ~CircularBuffer()
   {
     clear();
-    mAlloc.deallocate(mBuffer, mCap);
+    Deallocate(mBuffer, mCap);
     mBuffer = nullptr;
   }
 
   void clear()
   {
-    T* end = mBuffer + mCap;
-    T* iter = mStart;
-    while (iter != mEnd)
+    if constexpr (!std::is_trivially_destructible_v<T>)
     {
-      iter->~T();
-      iter = std::next(iter) == end ? mBuffer : std::next(iter);
+      T* iter = mStart;
+      for (size_t i = 0; i != mSize; ++i)
+      {
+        Destroy(iter);
+        iter = next(iter);
+      }
     }
     mEnd = mBuffer;
     mStart = mBuffer;
-    memset(mBuffer, INVALID, sizeof(T) * mCap);
+    mSize = 0;
   }
 
   size_t size() const noexcept
   {
-    if (mStart - mEnd == 0)
-      return *reinterpret_cast<unsigned char*>(mStart) != INVALID;
-
-    if (mStart - mEnd < 0)
-      return  mEnd - mStart + 1;
-
-    if (std::prev(mStart) == mEnd)
-      return mCap;
-
-    return mCap - (mStart - mEnd);
+    return mSize;
   }
 
+  // keeps the newest min(size(), sz) elements as a single contiguous run. Elements are
+  // relocated in one pass (memcpy for trivially relocatable T, move construction otherwise);
+  // an allocator with a reallocate hook lets trivially relocatable rings grow in place.
+  // If allocating or moving throws, the ring is left unchanged.
   void resize(size_t sz)
   {
-    T* tmp = mAlloc.allocate(sz);
-    if (mCap <= sz)
+    // growing keeps every element and may be done in place
+    if constexpr (detail::has_reallocate<Allocator>::value && is_trivially_relocatable_v<T>)
     {
-      memcpy(tmp, mBuffer, sizeof(T) * mCap);
-      if (sz - mCap)
-          memset(tmp + mCap, INVALID, sizeof(T) * (sz - mCap));
-      size_t start_pos = mStart - mBuffer;
-      size_t end_pos = mEnd - mBuffer;
-      mStart = tmp + start_pos;
-      mEnd = tmp + end_pos;
+      if (sz > mCap && mBuffer && grow_in_place(sz))
+        return;
     }
-    else
+
+    // the oldest elements do not fit anymore; they stay put until the newest ones made it
+    // into the new storage, so a failed allocation or move leaves the ring as it was
+    size_t kept = mSize < sz ? mSize : sz;
+    T* from = mStart;
+    for (size_t dropped = mSize - kept; dropped; --dropped)
+      from = next(from);
+
+    T* tmp = Allocate(sz);
+    try
     {
-      memcpy(tmp, mBuffer, sizeof(T) * sz);
-      size_t start_pos = mStart - mBuffer;
-      size_t curr_size = size();
-      mStart = tmp + start_pos % sz;
-      mEnd = mStart + curr_size % sz;
+      relocate(tmp, from, kept);
     }
-    mAlloc.deallocate(mBuffer, mCap);
+    catch (...)
+    {
+      alloc_traits::deallocate(mAlloc, tmp, sz);
+      throw;
+    }
+
+    for (; mSize != kept; --mSize)
+    {
+      Destroy(mStart);
+      mStart = next(mStart);
+    }
+    Deallocate(mBuffer, mCap);
     mBuffer = tmp;
     mCap = sz;
+    mSize = kept;
+    mStart = mBuffer;
+    mEnd = kept ? mBuffer + kept - 1 : mBuffer;
   }
 
   bool empty() const noexcept
   {
-    return mStart == mEnd && *reinterpret_cast<unsigned char*>(mStart) == INVALID;
+    return mSize == 0;
+  }
+
+  bool full() const noexcept
+  {
+    return mSize == mCap;
   }
 
   size_t capacity() const noexcept
@@ -337,7 +670,7 @@ public:
 
   T operator[](unsigned index) const
   {
-    if (index >= mCap)
+    if (index >= mSize)
       throw std::out_of_range{ "array out of bounds!" };
     T* iter = mStart + index;
     T* end = mBuffer + mCap;
@@ -349,7 +682,7 @@ public:
 
   T& operator[](unsigned index)
   {
-    if (index >= mCap)
+    if (index >= mSize)
       throw std::out_of_range{ "array out of bounds!" };
     T* iter = mStart + index;
     T* end = mBuffer + mCap;
@@ -361,40 +694,58 @@ public:
 
   void push(const T& value)
   {
-    if (empty())
-      *mStart = value;
-    else
-    {
-      T* end = mBuffer + mCap;
-      mEnd = std::next(mEnd) == end ? mBuffer : std::next(mEnd);
-      *mEnd = value;
-      if (mEnd == mStart)
-        mStart = std::next(mStart) == end ? mBuffer : std::next(mStart);
-    }
+    emplace(value);
   }
 
   template <typename ... Args>
   void emplace(Args&& ... args)
   {
-    if (empty())
-      new (mStart) T{ std::forward<Args>(args)... };
-    else
+    T* slot = mSize ? next(mEnd) : mStart;
+    if (mSize == mCap)
     {
-      T* end = mBuffer + mCap;
-      mEnd = std::next(mEnd) == end ? mBuffer : std::next(mEnd);
-      new (mEnd) T{ std::forward<Args>(args)... };
-      if (mEnd == mStart)
-        mStart = std::next(mStart) == end ? mBuffer : std::next(mStart);
+      // overwrite the oldest element
+      Destroy(mStart);
+      mStart = next(mStart);
+      --mSize;
     }
+    ConstructEmplaced(slot, std::forward<Args>(args)...);
+    mEnd = slot;
+    ++mSize;
+  }
+
+  // rejects the element instead of overwriting the oldest one when the buffer is full
+  bool try_push(const T& value)
+  {
+    return try_emplace(value);
+  }
+
+  template <typename ... Args>
+  bool try_emplace(Args&& ... args)
+  {
+    if (mSize == mCap)
+      return false;
+    emplace(std::forward<Args>(args)...);
+    return true;
   }
 
+  // removes the newest element
   void pop()
   {
-    mEnd->~T();
-    memset(mEnd, INVALID, sizeof(T));
-    if (mEnd == mStart)
+    if (!mSize)
       return;
-    mEnd = mEnd == mBuffer ? mBuffer + mCap - 1 : std::prev(mEnd);
+    Destroy(mEnd);
+    if (--mSize)
+      mEnd = prev(mEnd);
+  }
+
+  // removes the oldest element
+  void pop_front()
+  {
+    if (!mSize)
+      return;
+    Destroy(mStart);
+    if (--mSize)
+      mStart = next(mStart);
   }
 
   T at(unsigned index) const
@@ -432,6 +783,94 @@ public:
     return mBuffer;
   }
 
+  // appends [first, last) with at most two block copies, overwriting the oldest elements
+  // when the ring runs out of room (only the newest capacity() values are kept)
+  template <typename InputIt>
+  void push_range(InputIt first, InputIt last)
+  {
+    using category_t = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (!std::is_base_of_v<std::forward_iterator_tag, category_t>)
+    {
+      for (; first != last; ++first)
+        emplace(*first);
+    }
+    else
+    {
+      size_t count = static_cast<size_t>(std::distance(first, last));
+      if (!count || !mCap)
+        return;
+
+      if (count >= mCap)
+      {
+        clear();
+        std::advance(first, count - mCap);
+        count = mCap;
+      }
+      else if (mSize + count > mCap)
+      {
+        for (size_t dropped = mSize + count - mCap; dropped; --dropped, --mSize)
+        {
+          Destroy(mStart);
+          mStart = next(mStart);
+        }
+      }
+
+      T* slot = mSize ? next(mEnd) : mStart;
+      size_t first_part = static_cast<size_t>(mBuffer + mCap - slot);
+      if (first_part > count)
+        first_part = count;
+      construct_segment(slot, first, first_part);
+      construct_segment(mBuffer, first, count - first_part);
+    }
+  }
+
+  // moves up to n of the oldest elements into out and removes them, returns how many were moved
+  template <typename OutputIt>
+  size_t pop_range(OutputIt out, size_t n)
+  {
+    size_t count = n < mSize ? n : mSize;
+    if (!count)
+      return 0;
+
+    size_t first_part = static_cast<size_t>(mBuffer + mCap - mStart);
+    if (first_part > count)
+      first_part = count;
+    move_segment(mStart, first_part, out);
+    move_segment(mBuffer, count - first_part, out);
+
+    mStart = advance(mStart, count);
+    mSize -= count;
+    if (!mSize)
+      mEnd = mStart;
+    return count;
+  }
+
+  // oldest contiguous run of elements
+  Span<T> array_one() noexcept
+  {
+    size_t first_part = static_cast<size_t>(mBuffer + mCap - mStart);
+    return { mStart, first_part < mSize ? first_part : mSize };
+  }
+
+  Span<const T> array_one() const noexcept
+  {
+    size_t first_part = static_cast<size_t>(mBuffer + mCap - mStart);
+    return { mStart, first_part < mSize ? first_part : mSize };
+  }
+
+  // remaining elements that wrapped to the start of the storage, empty if none did
+  Span<T> array_two() noexcept
+  {
+    size_t first_part = static_cast<size_t>(mBuffer + mCap - mStart);
+    return { mBuffer, first_part < mSize ? mSize - first_part : 0 };
+  }
+
+  Span<const T> array_two() const noexcept
+  {
+    size_t first_part = static_cast<size_t>(mBuffer + mCap - mStart);
+    return { mBuffer, first_part < mSize ? mSize - first_part : 0 };
+  }
+
   Allocator get_allocator() const noexcept
   {
     return mAlloc;
@@ -447,51 +886,72 @@ public:
     return !operator==(rhs);
   }
 
-  void swap(CircularBuffer& rhs)
+  // like the standard containers, the allocators must compare equal unless they propagate on swap
+  void swap(CircularBuffer& rhs) noexcept
   {
-    CircularBuffer tmp{ *this };
-    *this = std::move(rhs);
-    rhs = std::move(tmp);
+    SwapStorage(rhs);
+    if constexpr (alloc_traits::propagate_on_container_swap::value)
+      std::swap(mAlloc, rhs.mAlloc);
   }
 
-  Iterator<T> begin() const noexcept
+  Iterator<T> begin() noexcept
   {
-    return mBuffer;
+    return { mBuffer, mCap, static_cast<size_t>(mStart - mBuffer) };
+  }
+
+  Iterator<T> end() noexcept
+  {
+    return { mBuffer, mCap, static_cast<size_t>(mStart - mBuffer) + mSize };
   }
 
-  Iterator<T> end() const noexcept
+  Iterator<const T> begin() const noexcept
   {
-    return mBuffer + mCap;
+    return cbegin();
+  }
+
+  Iterator<const T> end() const noexcept
+  {
+    return cend();
   }
 
   Iterator<const T> cbegin() const noexcept
   {
-    return mBuffer;
+    return { mBuffer, mCap, static_cast<size_t>(mStart - mBuffer) };
   }
 
   Iterator<const T> cend() const noexcept
   {
-    return mBuffer + mCap;
+    return { mBuffer, mCap, static_cast<size_t>(mStart - mBuffer) + mSize };
   }
 
-  ReverseIterator<T> rbegin() const noexcept
+  ReverseIterator<T> rbegin() noexcept
   {
-    return mBuffer + mCap;
+    return ReverseIterator<T>{ end() };
   }
 
-  ReverseIterator<T> rend() const noexcept
+  ReverseIterator<T> rend() noexcept
   {
-    return mBuffer;
+    return ReverseIterator<T>{ begin() };
+  }
+
+  ReverseIterator<const T> rbegin() const noexcept
+  {
+    return crbegin();
+  }
+
+  ReverseIterator<const T> rend() const noexcept
+  {
+    return crend();
   }
 
   ReverseIterator<const T> crbegin() const noexcept
   {
-    return mBuffer + mCap;
+    return ReverseIterator<const T>{ cend() };
   }
 
   ReverseIterator<const T> crend() const noexcept
   {
-    return mBuffer;
+    return ReverseIterator<const T>{ cbegin() };
   }
 
   using value_type = T;
@@ -508,4 +968,59 @@ public:
   using const_reverse_iterator = ReverseIterator<const T>;
 };
 
+// Segment-aware versions of the common algorithms. Each runs as (at most) two loops over
+// raw pointers, which the compiler can vectorise. They are found by argument-dependent
+// lookup, so an unqualified for_each(cb.begin(), cb.end(), f) picks them up.
+template <typename T1, typename FunctorT>
+FunctorT for_each(CircularBufferIterator<T1> first, CircularBufferIterator<T1> last, FunctorT f)
+{
+  auto [one, two] = segments(first, last);
+  return std::for_each(two.begin(), two.end(), std::for_each(one.begin(), one.end(), std::move(f)));
+}
+
+template <typename T1, typename ValueT>
+ValueT accumulate(CircularBufferIterator<T1> first, CircularBufferIterator<T1> last, ValueT init)
+{
+  auto [one, two] = segments(first, last);
+  init = std::accumulate(one.begin(), one.end(), std::move(init));
+  return std::accumulate(two.begin(), two.end(), std::move(init));
+}
+
+template <typename T1, typename ValueT, typename BinaryOpT>
+ValueT accumulate(CircularBufferIterator<T1> first, CircularBufferIterator<T1> last, ValueT init, BinaryOpT op)
+{
+  auto [one, two] = segments(first, last);
+  init = std::accumulate(one.begin(), one.end(), std::move(init), op);
+  return std::accumulate(two.begin(), two.end(), std::move(init), op);
+}
+
+template <typename T1, typename OutputIt>
+OutputIt copy(CircularBufferIterator<T1> first, CircularBufferIterator<T1> last, OutputIt out)
+{
+  auto [one, two] = segments(first, last);
+  out = std::copy(one.begin(), one.end(), out);
+  return std::copy(two.begin(), two.end(), out);
+}
+
+template <typename T1, typename ValueT>
+void fill(CircularBufferIterator<T1> first, CircularBufferIterator<T1> last, const ValueT& value)
+{
+  auto [one, two] = segments(first, last);
+  std::fill(one.begin(), one.end(), value);
+  std::fill(two.begin(), two.end(), value);
+}
+
+template <typename T1, typename ValueT>
+CircularBufferIterator<T1> find(CircularBufferIterator<T1> first, CircularBufferIterator<T1> last, const ValueT& value)
+{
+  auto [one, two] = segments(first, last);
+  T1* found = std::find(one.begin(), one.end(), value);
+  if (found != one.end())
+    return first + (found - one.begin());
+  found = std::find(two.begin(), two.end(), value);
+  if (found != two.end())
+    return first + static_cast<std::ptrdiff_t>(one.size()) + (found - two.begin());
+  return last;
+}
+
 }
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <containers/circular_buffer/include/circular_buffer.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace regit::containers {
+
+namespace detail
+{
+  // cache line aligned so every column starts on a vector friendly boundary
+  struct ColumnDeleter
+  {
+    void operator()(void* column) const noexcept
+    {
+      ::operator delete(column, std::align_val_t{ 64 });
+    }
+  };
+
+  template <typename T>
+  std::unique_ptr<T[], ColumnDeleter> AllocateColumn(size_t size)
+  {
+    T* column = static_cast<T*>(::operator new(sizeof(T) * size, std::align_val_t{ 64 }));
+    std::uninitialized_value_construct_n(column, size);
+    return std::unique_ptr<T[], ColumnDeleter>{ column };
+  }
+
+} // detail namespace
+
+// Structure-of-arrays CircularBuffer for records made of the fields Ts...
+// Every field lives in its own ring array and all of them share one head and size, so a
+// query over a single field only streams that field through the cache. column<I>() hands out
+// the live part of a column as (at most) two contiguous spans, oldest first.
+template <typename ... Ts>
+class ColumnarCircularBuffer
+{
+  static_assert(sizeof...(Ts) != 0, "ColumnarCircularBuffer needs at least one column");
+  static_assert((std::is_trivially_copyable_v<Ts> && ...), "ColumnarCircularBuffer requires trivially copyable fields");
+
+  using columns_t = std::tuple<std::unique_ptr<Ts[], detail::ColumnDeleter>...>;
+  static constexpr auto INDICES = std::index_sequence_for<Ts...>{ };
+
+  size_t mCap;
+  size_t mStart;
+  size_t mSize;
+  columns_t mColumns;
+
+  size_t Wrap(size_t position) const noexcept
+  {
+    return position >= mCap ? position - mCap : position;
+  }
+
+  template <size_t ... Is, typename ... Args>
+  void Store(size_t slot, std::index_sequence<Is...>, Args&& ... fields) noexcept
+  {
+    ((std::get<Is>(mColumns)[slot] = std::forward<Args>(fields)), ...);
+  }
+
+  template <size_t ... Is>
+  std::tuple<Ts...> Load(size_t slot, std::index_sequence<Is...>) const noexcept
+  {
+    return { std::get<Is>(mColumns)[slot]... };
+  }
+
+public:
+  template <size_t I>
+  using column_type = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+  using value_type = std::tuple<Ts...>;
+
+  explicit ColumnarCircularBuffer(size_t size = 1)
+    : mCap{ size ? size : 1 }, mStart{ 0 }, mSize{ 0 },
+      mColumns{ detail::AllocateColumn<Ts>(mCap)... }
+  { }
+
+  ColumnarCircularBuffer(const ColumnarCircularBuffer& rhs)
+    : mCap{ rhs.mCap }, mStart{ rhs.mStart }, mSize{ rhs.mSize },
+      mColumns{ detail::AllocateColumn<Ts>(rhs.mCap)... }
+  {
+    CopyColumns(rhs, INDICES);
+  }
+
+  ColumnarCircularBuffer(ColumnarCircularBuffer&&) noexcept = default;
+
+  ColumnarCircularBuffer& operator=(const ColumnarCircularBuffer& rhs)
+  {
+    if (this != &rhs)
+      *this = ColumnarCircularBuffer{ rhs };
+    return *this;
+  }
+
+  ColumnarCircularBuffer& operator=(ColumnarCircularBuffer&&) noexcept = default;
+
+  // appends a record, overwriting the oldest one when the buffer is full
+  void push(const Ts& ... fields) noexcept
+  {
+    size_t slot = Wrap(mStart + mSize);
+    if (mSize == mCap)
+      mStart = Wrap(mStart + 1);
+    else
+      ++mSize;
+    Store(slot, INDICES, fields...);
+  }
+
+  void push(const std::tuple<Ts...>& record) noexcept
+  {
+    std::apply([this](const Ts& ... fields) { push(fields...); }, record);
+  }
+
+  // removes the newest record
+  void pop() noexcept
+  {
+    if (mSize)
+      --mSize;
+  }
+
+  // removes the oldest record
+  void pop_front() noexcept
+  {
+    if (!mSize)
+      return;
+    mStart = Wrap(mStart + 1);
+    --mSize;
+  }
+
+  void clear() noexcept
+  {
+    mStart = 0;
+    mSize = 0;
+  }
+
+  size_t size() const noexcept
+  {
+    return mSize;
+  }
+
+  bool empty() const noexcept
+  {
+    return mSize == 0;
+  }
+
+  bool full() const noexcept
+  {
+    return mSize == mCap;
+  }
+
+  size_t capacity() const noexcept
+  {
+    return mCap;
+  }
+
+  // field I of the index-th oldest record
+  template <size_t I>
+  column_type<I>& get(size_t index) noexcept
+  {
+    return std::get<I>(mColumns)[Wrap(mStart + index)];
+  }
+
+  template <size_t I>
+  const column_type<I>& get(size_t index) const noexcept
+  {
+    return std::get<I>(mColumns)[Wrap(mStart + index)];
+  }
+
+  // the index-th oldest record, gathered from every column
+  std::tuple<Ts...> operator[](size_t index) const noexcept
+  {
+    return Load(Wrap(mStart + index), INDICES);
+  }
+
+  std::tuple<Ts...> at(size_t index) const
+  {
+    if (index >= mSize)
+      throw std::out_of_range{ "array out of bounds!" };
+    return operator[](index);
+  }
+
+  std::tuple<Ts...> front() const noexcept
+  {
+    return operator[](0);
+  }
+
+  std::tuple<Ts...> back() const noexcept
+  {
+    return operator[](mSize - 1);
+  }
+
+  // live values of column I from the oldest to the newest, as at most two contiguous runs
+  template <size_t I>
+  std::pair<Span<column_type<I>>, Span<column_type<I>>> column() noexcept
+  {
+    column_type<I>* data = std::get<I>(mColumns).get();
+    return segments(CircularBufferIterator<column_type<I>>{ data, mCap, mStart },
+      CircularBufferIterator<column_type<I>>{ data, mCap, mStart + mSize });
+  }
+
+  template <size_t I>
+  std::pair<Span<const column_type<I>>, Span<const column_type<I>>> column() const noexcept
+  {
+    const column_type<I>* data = std::get<I>(mColumns).get();
+    return segments(CircularBufferIterator<const column_type<I>>{ data, mCap, mStart },
+      CircularBufferIterator<const column_type<I>>{ data, mCap, mStart + mSize });
+  }
+
+private:
+  template <size_t ... Is>
+  void CopyColumns(const ColumnarCircularBuffer& rhs, std::index_sequence<Is...>) noexcept
+  {
+    ((std::copy(std::get<Is>(rhs.mColumns).get(), std::get<Is>(rhs.mColumns).get() + mCap,
+      std::get<Is>(mColumns).get())), ...);
+  }
+};
+
+}
@@ -0,0 +1,471 @@
+#pragma once
+
+#include <containers/circular_buffer/include/circular_buffer.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace regit::containers {
+
+namespace detail
+{
+  // appends bit fields to a vector of words, most significant bit first
+  class BitWriter
+  {
+    std::vector<uint64_t>& mWords;
+    unsigned mUsed;
+
+  public:
+    explicit BitWriter(std::vector<uint64_t>& words) noexcept
+      : mWords{ words }, mUsed{ 64 }
+    { }
+
+    // writes the low bits (1 to 64) of value
+    void write(uint64_t value, unsigned bits)
+    {
+      if (bits < 64)
+        value &= (uint64_t{ 1 } << bits) - 1;
+      if (mUsed == 64)
+      {
+        mWords.push_back(0);
+        mUsed = 0;
+      }
+
+      unsigned free = 64 - mUsed;
+      if (bits <= free)
+      {
+        mWords.back() |= value << (free - bits);
+        mUsed += bits;
+      }
+      else
+      {
+        unsigned rest = bits - free;
+        mWords.back() |= value >> rest;
+        mWords.push_back(value << (64 - rest));
+        mUsed = rest;
+      }
+    }
+  };
+
+  class BitReader
+  {
+    const uint64_t* mWords;
+    size_t mPosition;
+
+  public:
+    BitReader() noexcept
+      : mWords{ nullptr }, mPosition{ 0 }
+    { }
+
+    explicit BitReader(const uint64_t* words) noexcept
+      : mWords{ words }, mPosition{ 0 }
+    { }
+
+    uint64_t read(unsigned bits) noexcept
+    {
+      const size_t word = mPosition / 64;
+      const unsigned offset = mPosition % 64;
+      const unsigned available = 64 - offset;
+      mPosition += bits;
+
+      uint64_t result = (mWords[word] << offset) >> (64 - bits);
+      if (bits > available)
+        result |= mWords[word + 1] >> (64 - (bits - available));
+      return result;
+    }
+  };
+
+  // Gorilla style codecs over the 64 bit image of a value. Integers store the delta of the
+  // delta between consecutive values in a prefix coded number of bits, so a counter moving
+  // at a steady rate costs one bit per value. Floating point values store the XOR with the
+  // previous value, reusing the previous run of meaningful bits whenever it still fits.
+  template <typename T>
+  class NumericCodec
+  {
+    static constexpr bool FLOATING = std::is_floating_point_v<T>;
+    static constexpr unsigned NO_WINDOW = 64;
+
+    uint64_t mPrevious = 0;
+    uint64_t mDelta = 0;
+    unsigned mLeading = NO_WINDOW;
+    unsigned mTrailing = 0;
+    size_t mCount = 0;
+
+    static bool Fits(int64_t value, unsigned bits) noexcept
+    {
+      const int64_t limit = int64_t{ 1 } << (bits - 1);
+      return value >= -limit && value < limit;
+    }
+
+    static int64_t SignExtend(uint64_t value, unsigned bits) noexcept
+    {
+      const uint64_t sign = uint64_t{ 1 } << (bits - 1);
+      int64_t result = (value ^ sign) - sign;
+      return result;
+    }
+
+    void WriteDeltaOfDelta(BitWriter& writer, int64_t dod)
+    {
+      if (dod == 0)
+        writer.write(0b0, 1);
+      else if (Fits(dod, 7))
+      {
+        writer.write(0b10, 2);
+        writer.write(dod, 7);
+      }
+      else if (Fits(dod, 12))
+      {
+        writer.write(0b110, 3);
+        writer.write(dod, 12);
+      }
+      else if (Fits(dod, 20))
+      {
+        writer.write(0b1110, 4);
+        writer.write(dod, 20);
+      }
+      else
+      {
+        writer.write(0b1111, 4);
+        writer.write(dod, 64);
+      }
+    }
+
+    static int64_t ReadDeltaOfDelta(BitReader& reader) noexcept
+    {
+      if (!reader.read(1))
+        return 0;
+      if (!reader.read(1))
+        return SignExtend(reader.read(7), 7);
+      if (!reader.read(1))
+        return SignExtend(reader.read(12), 12);
+      if (!reader.read(1))
+        return SignExtend(reader.read(20), 20);
+      int64_t result = reader.read(64);
+      return result;
+    }
+
+    void WriteXor(BitWriter& writer, uint64_t bits)
+    {
+      const uint64_t diff = bits ^ mPrevious;
+      if (!diff)
+      {
+        writer.write(0b0, 1);
+        return;
+      }
+
+      unsigned leading = static_cast<unsigned>(__builtin_clzll(diff));
+      unsigned trailing = static_cast<unsigned>(__builtin_ctzll(diff));
+      if (leading > 31)
+        leading = 31;
+
+      if (mLeading != NO_WINDOW && leading >= mLeading && trailing >= mTrailing)
+      {
+        writer.write(0b10, 2);
+        writer.write(diff >> mTrailing, 64 - mLeading - mTrailing);
+        return;
+      }
+
+      const unsigned meaningful = 64 - leading - trailing;
+      writer.write(0b11, 2);
+      writer.write(leading, 5);
+      // 64 meaningful bits are stored as 0, there is always at least one
+      writer.write(meaningful, 6);
+      writer.write(diff >> trailing, meaningful);
+      mLeading = leading;
+      mTrailing = trailing;
+    }
+
+    uint64_t ReadXor(BitReader& reader) noexcept
+    {
+      if (!reader.read(1))
+        return mPrevious;
+      if (reader.read(1))
+      {
+        mLeading = static_cast<unsigned>(reader.read(5));
+        unsigned meaningful = static_cast<unsigned>(reader.read(6));
+        mTrailing = 64 - mLeading - (meaningful ? meaningful : 64);
+      }
+      return mPrevious ^ (reader.read(64 - mLeading - mTrailing) << mTrailing);
+    }
+
+  public:
+    static uint64_t ToBits(T value) noexcept
+    {
+      uint64_t bits;
+      if constexpr (FLOATING)
+      {
+        // floats widen losslessly, and their XORs keep 29 trailing zero bits
+        double wide = value;
+        memcpy(&bits, &wide, sizeof(bits));
+      }
+      else if constexpr (std::is_signed_v<T>)
+      {
+        int64_t wide = value;
+        bits = wide;
+      }
+      else
+        bits = value;
+      return bits;
+    }
+
+    static T FromBits(uint64_t bits) noexcept
+    {
+      if constexpr (FLOATING)
+      {
+        double wide;
+        memcpy(&wide, &bits, sizeof(wide));
+        T value = wide;
+        return value;
+      }
+      else
+      {
+        T value = bits;
+        return value;
+      }
+    }
+
+    void encode(BitWriter& writer, T value)
+    {
+      const uint64_t bits = ToBits(value);
+      if (mCount++ == 0)
+        writer.write(bits, 64);
+      else if constexpr (FLOATING)
+        WriteXor(writer, bits);
+      else
+      {
+        const uint64_t delta = bits - mPrevious;
+        int64_t dod = delta - mDelta;
+        WriteDeltaOfDelta(writer, dod);
+        mDelta = delta;
+      }
+      mPrevious = bits;
+    }
+
+    T decode(BitReader& reader) noexcept
+    {
+      if (mCount++ == 0)
+        mPrevious = reader.read(64);
+      else if constexpr (FLOATING)
+        mPrevious = ReadXor(reader);
+      else
+      {
+        mDelta += ReadDeltaOfDelta(reader);
+        mPrevious += mDelta;
+      }
+      return FromBits(mPrevious);
+    }
+  };
+
+} // detail namespace
+
+// CircularBuffer of integers or floating point values stored in compressed blocks.
+// The newest BlockSize values stay uncompressed, so push and back() cost the same as in
+// a plain array; once that block fills up it is encoded (delta-of-delta for integers,
+// XOR for floating point values, both lossless) and appended to a ring of blocks. When the
+// ring is full the oldest block, i.e. the oldest BlockSize values, is dropped as a whole.
+// Iteration decodes the blocks as a stream from the oldest to the newest value.
+template <typename T, size_t BlockSize = 256>
+class CompressedCircularBuffer
+{
+  static_assert(std::is_arithmetic_v<T> && sizeof(T) <= 8, "CompressedCircularBuffer requires a numeric T");
+  static_assert(BlockSize >= 2, "blocks need at least two values");
+
+  using codec_t = detail::NumericCodec<T>;
+
+  struct Block
+  {
+    std::vector<uint64_t> Words;
+    T Last;
+  };
+
+  CircularBuffer<Block> mBlocks;
+  std::vector<T> mHead;
+
+  const Block& BlockAt(size_t index) const noexcept
+  {
+    return *(mBlocks.cbegin() + static_cast<std::ptrdiff_t>(index));
+  }
+
+  void Seal()
+  {
+    Block block{ { }, mHead.back() };
+    // typically a few bits per value, reserving for the worst case would defeat the purpose
+    block.Words.reserve(BlockSize / 8);
+    detail::BitWriter writer{ block.Words };
+    codec_t codec;
+    for (T value : mHead)
+      codec.encode(writer, value);
+    block.Words.shrink_to_fit();
+
+    mBlocks.emplace(std::move(block));
+    mHead.clear();
+  }
+
+public:
+  // Walks the values from the oldest to the newest, decoding one block at a time
+  class const_iterator
+  {
+    const CompressedCircularBuffer* mOwner;
+    size_t mBlock;
+    size_t mIndex;
+    detail::BitReader mReader;
+    codec_t mCodec;
+    T mValue;
+
+    void Load() noexcept
+    {
+      if (mBlock != mOwner->mBlocks.size())
+      {
+        if (mIndex == 0)
+        {
+          mReader = detail::BitReader{ mOwner->BlockAt(mBlock).Words.data() };
+          mCodec = codec_t{ };
+        }
+        mValue = mCodec.decode(mReader);
+      }
+      else if (mIndex != mOwner->mHead.size())
+        mValue = mOwner->mHead[mIndex];
+    }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const_iterator() noexcept
+      : mOwner{ nullptr }, mBlock{ 0 }, mIndex{ 0 }, mReader{ }, mCodec{ }, mValue{ }
+    { }
+
+    const_iterator(const CompressedCircularBuffer* owner, size_t block, size_t index) noexcept
+      : mOwner{ owner }, mBlock{ block }, mIndex{ index }, mReader{ }, mCodec{ }, mValue{ }
+    {
+      Load();
+    }
+
+    reference operator*() const noexcept
+    {
+      return mValue;
+    }
+
+    pointer operator->() const noexcept
+    {
+      return &mValue;
+    }
+
+    const_iterator& operator++() noexcept
+    {
+      if (mBlock != mOwner->mBlocks.size() && ++mIndex == BlockSize)
+      {
+        ++mBlock;
+        mIndex = 0;
+      }
+      else if (mBlock == mOwner->mBlocks.size())
+        ++mIndex;
+      Load();
+      return *this;
+    }
+
+    const_iterator operator++(int) noexcept
+    {
+      const_iterator result{ *this };
+      ++*this;
+      return result;
+    }
+
+    bool operator==(const const_iterator& rhs) const noexcept
+    {
+      return mBlock == rhs.mBlock && mIndex == rhs.mIndex;
+    }
+
+    bool operator!=(const const_iterator& rhs) const noexcept
+    {
+      return !operator==(rhs);
+    }
+  };
+
+  // keeps at least the newest size values
+  explicit CompressedCircularBuffer(size_t size = BlockSize)
+    : mBlocks((size + BlockSize - 1) / BlockSize ? (size + BlockSize - 1) / BlockSize : 1), mHead()
+  {
+    mHead.reserve(BlockSize);
+  }
+
+  void push(T value)
+  {
+    mHead.push_back(value);
+    if (mHead.size() == BlockSize)
+      Seal();
+  }
+
+  void clear()
+  {
+    mBlocks.clear();
+    mHead.clear();
+  }
+
+  size_t size() const noexcept
+  {
+    return mBlocks.size() * BlockSize + mHead.size();
+  }
+
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  // most values held before the oldest block is dropped
+  size_t capacity() const noexcept
+  {
+    return mBlocks.capacity() * BlockSize + BlockSize - 1;
+  }
+
+  T back() const noexcept
+  {
+    return mHead.empty() ? BlockAt(mBlocks.size() - 1).Last : mHead.back();
+  }
+
+  T front() const noexcept
+  {
+    return *begin();
+  }
+
+  const_iterator begin() const noexcept
+  {
+    return { this, 0, 0 };
+  }
+
+  const_iterator end() const noexcept
+  {
+    return { this, mBlocks.size(), mHead.size() };
+  }
+
+  const_iterator cbegin() const noexcept
+  {
+    return begin();
+  }
+
+  const_iterator cend() const noexcept
+  {
+    return end();
+  }
+
+  // bytes held by the values, compressed blocks plus the uncompressed newest block
+  size_t memory_usage() const noexcept
+  {
+    size_t bytes = mHead.capacity() * sizeof(T) + mBlocks.capacity() * sizeof(Block);
+    for (const Block& block : mBlocks)
+      bytes += block.Words.capacity() * sizeof(uint64_t);
+    return bytes;
+  }
+
+  using value_type = T;
+  using size_type = size_t;
+};
+
+}
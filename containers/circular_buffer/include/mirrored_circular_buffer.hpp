@@ -0,0 +1,369 @@
+#pragma once
+
+#include <containers/common/include/system_error.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#if !defined(__linux__)
+#error "MirroredCircularBuffer relies on memfd_create and is only available on Linux"
+#endif
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace regit::containers {
+
+// CircularBuffer whose storage is mapped twice back to back in virtual memory.
+// Slot i and slot i + capacity() are the same physical memory, so the live elements always
+// form a single contiguous run starting at data(), no matter where the ring wraps.
+// The capacity is rounded up so that the storage is a whole number of pages.
+// Elements are always constructed and destroyed through the first mapping, and the element
+// accessors return first mapping addresses too. Types that are not trivially copyable may
+// point into themselves (e.g. a std::string holding a short value), so for them the
+// contiguous view from data(), begin() and end() is only meant for reading.
+template <typename T>
+class MirroredCircularBuffer
+{
+  size_t mCap;
+  size_t mBytes;
+  T* mBuffer;
+  size_t mStart;
+  size_t mSize;
+
+  static size_t RoundUpCapacity(size_t size)
+  {
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t a = page, b = sizeof(T);
+    while (b)
+      a = std::exchange(b, a % b);
+    // smallest element count whose storage is a multiple of the page size
+    const size_t unit = page / a;
+    size_t cap = size ? size : 1;
+    return (cap + unit - 1) / unit * unit;
+  }
+
+  T* Map()
+  {
+    int fd = memfd_create("regit_mirrored_circular_buffer", MFD_CLOEXEC);
+    if (fd == -1)
+      detail::ThrowSystemError("memfd_create failed");
+
+    if (ftruncate(fd, static_cast<off_t>(mBytes)) == -1)
+    {
+      close(fd);
+      detail::ThrowSystemError("ftruncate failed");
+    }
+
+    // reserve both halves first so nothing else can be mapped in between
+    void* base = mmap(nullptr, mBytes * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+    {
+      close(fd);
+      detail::ThrowSystemError("mmap reservation failed");
+    }
+
+    char* first = static_cast<char*>(base);
+    char* second = first + mBytes;
+    if (mmap(first, mBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED
+      || mmap(second, mBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+      munmap(base, mBytes * 2);
+      close(fd);
+      detail::ThrowSystemError("mmap mirror failed");
+    }
+
+    // the mappings keep the memory alive
+    close(fd);
+    return reinterpret_cast<T*>(first);
+  }
+
+  // position of the newest element plus one, always below 2 * mCap
+  T* write_slot() const noexcept
+  {
+    return mBuffer + mStart + mSize;
+  }
+
+  // pos below 2 * mCap, folded into the first mapping
+  T* slot(size_t pos) const noexcept
+  {
+    return mBuffer + (pos < mCap ? pos : pos - mCap);
+  }
+
+  T* element(size_t index) const noexcept
+  {
+    if constexpr (std::is_trivially_copyable_v<T>)
+      return data() + index;
+    else
+      return slot(mStart + index);
+  }
+
+  void destroy_front(size_t count) noexcept
+  {
+    if constexpr (!std::is_trivially_destructible_v<T>)
+    {
+      for (size_t i = 0; i != count; ++i)
+        slot(mStart + i)->~T();
+    }
+  }
+
+  void advance_start(size_t count) noexcept
+  {
+    mStart += count;
+    if (mStart >= mCap)
+      mStart -= mCap;
+  }
+
+public:
+  explicit MirroredCircularBuffer(size_t size = 1)
+    : mCap{ RoundUpCapacity(size) }, mBytes{ mCap * sizeof(T) }, mBuffer{ Map() },
+      mStart{ 0 }, mSize{ 0 }
+  { }
+
+  MirroredCircularBuffer(const MirroredCircularBuffer&) = delete;
+  MirroredCircularBuffer& operator=(const MirroredCircularBuffer&) = delete;
+
+  MirroredCircularBuffer(MirroredCircularBuffer&& rhs) noexcept
+    : mCap{ rhs.mCap }, mBytes{ rhs.mBytes }, mBuffer{ rhs.mBuffer },
+      mStart{ rhs.mStart }, mSize{ rhs.mSize }
+  {
+    rhs.mCap = 0;
+    rhs.mBytes = 0;
+    rhs.mBuffer = nullptr;
+    rhs.mStart = 0;
+    rhs.mSize = 0;
+  }
+
+  MirroredCircularBuffer& operator=(MirroredCircularBuffer&& rhs) noexcept
+  {
+    std::swap(mCap, rhs.mCap);
+    std::swap(mBytes, rhs.mBytes);
+    std::swap(mBuffer, rhs.mBuffer);
+    std::swap(mStart, rhs.mStart);
+    std::swap(mSize, rhs.mSize);
+    return *this;
+  }
+
+  ~MirroredCircularBuffer()
+  {
+    clear();
+    if (mBuffer)
+      munmap(mBuffer, mBytes * 2);
+    mBuffer = nullptr;
+  }
+
+  void clear() noexcept
+  {
+    destroy_front(mSize);
+    mStart = 0;
+    mSize = 0;
+  }
+
+  size_t size() const noexcept
+  {
+    return mSize;
+  }
+
+  bool empty() const noexcept
+  {
+    return mSize == 0;
+  }
+
+  bool full() const noexcept
+  {
+    return mSize == mCap;
+  }
+
+  size_t capacity() const noexcept
+  {
+    return mCap;
+  }
+
+  // the oldest element, followed contiguously by the other size() - 1 elements
+  T* data() const noexcept
+  {
+    return mBuffer + mStart;
+  }
+
+  const T& operator[](size_t index) const noexcept
+  {
+    return *element(index);
+  }
+
+  T& operator[](size_t index) noexcept
+  {
+    return *element(index);
+  }
+
+  const T& at(size_t index) const
+  {
+    if (index >= mSize)
+      throw std::out_of_range{ "array out of bounds!" };
+    return *element(index);
+  }
+
+  T& at(size_t index)
+  {
+    if (index >= mSize)
+      throw std::out_of_range{ "array out of bounds!" };
+    return *element(index);
+  }
+
+  const T& front() const noexcept
+  {
+    return *element(0);
+  }
+
+  T& front() noexcept
+  {
+    return *element(0);
+  }
+
+  const T& back() const noexcept
+  {
+    return *element(mSize - 1);
+  }
+
+  T& back() noexcept
+  {
+    return *element(mSize - 1);
+  }
+
+  void push(const T& value)
+  {
+    emplace(value);
+  }
+
+  template <typename ... Args>
+  void emplace(Args&& ... args)
+  {
+    if (mSize == mCap)
+      pop_front();
+    new (slot(mStart + mSize)) T{ std::forward<Args>(args)... };
+    ++mSize;
+  }
+
+  // appends [first, last) as a single copy, keeping only the newest capacity() values
+  template <typename InputIt>
+  void push_range(InputIt first, InputIt last)
+  {
+    using category_t = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (!std::is_base_of_v<std::forward_iterator_tag, category_t>)
+    {
+      for (; first != last; ++first)
+        emplace(*first);
+    }
+    else
+    {
+      size_t count = static_cast<size_t>(std::distance(first, last));
+      if (count >= mCap)
+      {
+        clear();
+        std::advance(first, count - mCap);
+        count = mCap;
+      }
+      else if (mSize + count > mCap)
+        consume(mSize + count - mCap);
+
+      if constexpr (std::is_trivially_copyable_v<T> && std::is_pointer_v<InputIt>)
+      {
+        memcpy(write_slot(), first, sizeof(T) * count);
+        mSize += count;
+      }
+      else
+      {
+        for (size_t i = 0; i != count; ++i, ++first)
+        {
+          new (slot(mStart + mSize)) T(*first);
+          ++mSize;
+        }
+      }
+    }
+  }
+
+  // removes the newest element
+  void pop() noexcept
+  {
+    --mSize;
+    slot(mStart + mSize)->~T();
+  }
+
+  // removes the oldest element
+  void pop_front() noexcept
+  {
+    slot(mStart)->~T();
+    advance_start(1);
+    --mSize;
+  }
+
+  // removes the count oldest elements
+  void consume(size_t count) noexcept
+  {
+    if (count > mSize)
+      count = mSize;
+    destroy_front(count);
+    advance_start(count);
+    mSize -= count;
+  }
+
+  // contiguous free space after the newest element, for filling the ring in place
+  // (e.g. straight from read/recv); the written elements are published with commit
+  T* write_data() const noexcept
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "write_data requires a trivially copyable T");
+    return write_slot();
+  }
+
+  size_t write_capacity() const noexcept
+  {
+    return mCap - mSize;
+  }
+
+  // count must not exceed write_capacity(); anything beyond it was never written into the
+  // free space and is dropped, so a bad length cannot push the size past the capacity
+  void commit(size_t count) noexcept
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "commit requires a trivially copyable T");
+    mSize += std::min(count, write_capacity());
+  }
+
+  T* begin() const noexcept
+  {
+    return data();
+  }
+
+  T* end() const noexcept
+  {
+    return data() + mSize;
+  }
+
+  const T* cbegin() const noexcept
+  {
+    return data();
+  }
+
+  const T* cend() const noexcept
+  {
+    return data() + mSize;
+  }
+
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = T*;
+  using const_iterator = const T*;
+};
+
+}
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <containers/common/include/ring_utility.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace regit::containers {
+
+// Position of a writer or a consumer in a MulticastRingBuffer, alone on its cache line.
+// Starts at -1, i.e. nothing has been published/processed yet.
+class alignas(64) Sequence
+{
+  std::atomic<int64_t> mValue;
+
+public:
+  static constexpr int64_t INITIAL = -1;
+  // attempts a writer or consumer spins while waiting on a sequence before it yields
+  static constexpr unsigned SPIN_LIMIT = 128;
+
+  explicit Sequence(int64_t value = INITIAL) noexcept
+    : mValue{ value }
+  { }
+
+  Sequence(const Sequence&) = delete;
+  Sequence& operator=(const Sequence&) = delete;
+
+  int64_t load() const noexcept
+  {
+    return mValue.load(std::memory_order_acquire);
+  }
+
+  void store(int64_t value) noexcept
+  {
+    mValue.store(value, std::memory_order_release);
+  }
+};
+
+template <typename T>
+class MulticastRingBuffer;
+
+// Tells a consumer up to which sequence it may read: the writer's cursor, further limited by
+// the consumers it has to run after.
+template <typename T>
+class SequenceBarrier
+{
+  const MulticastRingBuffer<T>* mRing;
+  std::vector<const Sequence*> mDependencies;
+
+public:
+  SequenceBarrier(const MulticastRingBuffer<T>& ring, std::vector<const Sequence*> dependencies)
+    : mRing{ &ring }, mDependencies{ std::move(dependencies) }
+  { }
+
+  // highest sequence that is safe to read right now
+  int64_t available() const noexcept
+  {
+    int64_t result = mRing->cursor();
+    for (const Sequence* dependency : mDependencies)
+      result = std::min(result, dependency->load());
+    return result;
+  }
+
+  // waits until sequence is readable and returns the highest readable sequence, which may be
+  // well past it so the caller can process the whole batch at once; returns a value below
+  // sequence only if the ring was halted while waiting
+  int64_t wait_for(int64_t sequence) const noexcept
+  {
+    unsigned attempt = 0;
+    int64_t result;
+    while ((result = available()) < sequence && !mRing->halted())
+      detail::Backoff(attempt, Sequence::SPIN_LIMIT);
+    return result;
+  }
+};
+
+// Single-writer ring that multicasts every slot to several consumers.
+// Each consumer tracks its own Sequence, consumers can be ordered with SequenceBarriers
+// (B only sees a slot once A has processed it) and the writer never laps the slowest gating
+// consumer. Slots are constructed once and reused, the writer fills them in place.
+template <typename T>
+class MulticastRingBuffer
+{
+  size_t mCap;
+  size_t mMask;
+  std::unique_ptr<T[]> mEntries;
+  std::vector<const Sequence*> mGating;
+  std::atomic<bool> mHalted;
+
+  // writer side
+  Sequence mCursor;
+  int64_t mNext;
+  int64_t mCachedGate;
+
+  int64_t MinimumGate(int64_t fallback) const noexcept
+  {
+    int64_t result = fallback;
+    for (const Sequence* gate : mGating)
+      result = std::min(result, gate->load());
+    return result;
+  }
+
+public:
+  // what claim returns instead of a sequence when it cannot reserve the slots
+  static constexpr int64_t CLAIM_FAILED = std::numeric_limits<int64_t>::min();
+
+  explicit MulticastRingBuffer(size_t size)
+    : mCap{ detail::RoundUpPowerOfTwo(size) }, mMask{ mCap - 1 }, mEntries{ new T[mCap]{ } },
+      mGating{ }, mHalted{ false }, mCursor{ }, mNext{ 0 }, mCachedGate{ Sequence::INITIAL }
+  { }
+
+  MulticastRingBuffer(const MulticastRingBuffer&) = delete;
+  MulticastRingBuffer& operator=(const MulticastRingBuffer&) = delete;
+
+  // the writer will not overwrite a slot until every gating sequence has moved past it;
+  // add the last consumer of every chain before publishing anything
+  void add_gating_sequence(const Sequence& sequence)
+  {
+    mGating.push_back(&sequence);
+  }
+
+  SequenceBarrier<T> new_barrier(std::initializer_list<const Sequence*> dependencies = { }) const
+  {
+    return SequenceBarrier<T>{ *this, dependencies };
+  }
+
+  // writer: reserves the next count sequences and returns the last of them,
+  // waiting for the slowest consumer if the ring is full. Returns CLAIM_FAILED and reserves
+  // nothing once the ring is halted or if count exceeds the capacity, which no wait satisfies
+  int64_t claim(size_t count = 1) noexcept
+  {
+    if (count > mCap || halted())
+      return CLAIM_FAILED;
+
+    const int64_t last = mNext + static_cast<int64_t>(count) - 1;
+    const int64_t wrapPoint = last - static_cast<int64_t>(mCap);
+    if (wrapPoint > mCachedGate)
+    {
+      unsigned attempt = 0;
+      while (wrapPoint > (mCachedGate = MinimumGate(mCursor.load())))
+      {
+        // the consumers may never get to the slots we would overwrite
+        if (halted())
+          return CLAIM_FAILED;
+        detail::Backoff(attempt, Sequence::SPIN_LIMIT);
+      }
+    }
+    mNext = last + 1;
+    return last;
+  }
+
+  // writer: makes every sequence up to and including sequence visible to the consumers
+  void publish(int64_t sequence) noexcept
+  {
+    mCursor.store(sequence);
+  }
+
+  // false if the ring was halted and nothing was published
+  template <typename ... Args>
+  bool emplace(Args&& ... args)
+  {
+    int64_t sequence = claim();
+    if (sequence == CLAIM_FAILED)
+      return false;
+    (*this)[sequence] = T{ std::forward<Args>(args)... };
+    publish(sequence);
+    return true;
+  }
+
+  bool push(const T& value)
+  {
+    int64_t sequence = claim();
+    if (sequence == CLAIM_FAILED)
+      return false;
+    (*this)[sequence] = value;
+    publish(sequence);
+    return true;
+  }
+
+  T& operator[](int64_t sequence) noexcept
+  {
+    return mEntries[static_cast<size_t>(sequence) & mMask];
+  }
+
+  const T& operator[](int64_t sequence) const noexcept
+  {
+    return mEntries[static_cast<size_t>(sequence) & mMask];
+  }
+
+  // last published sequence
+  int64_t cursor() const noexcept
+  {
+    return mCursor.load();
+  }
+
+  size_t capacity() const noexcept
+  {
+    return mCap;
+  }
+
+  // wakes up every waiting writer and consumer, used for shutdown
+  void halt() noexcept
+  {
+    mHalted.store(true, std::memory_order_release);
+  }
+
+  bool halted() const noexcept
+  {
+    return mHalted.load(std::memory_order_acquire);
+  }
+};
+
+// Consumer that owns a Sequence and processes whole batches of available slots.
+template <typename T>
+class BatchConsumer
+{
+  MulticastRingBuffer<T>* mRing;
+  SequenceBarrier<T> mBarrier;
+  Sequence mSequence;
+
+public:
+  BatchConsumer(MulticastRingBuffer<T>& ring, std::initializer_list<const Sequence*> dependencies = { })
+    : mRing{ &ring }, mBarrier{ ring.new_barrier(dependencies) }, mSequence{ }
+  { }
+
+  const Sequence& sequence() const noexcept
+  {
+    return mSequence;
+  }
+
+  // handler(T& entry, int64_t sequence, bool endOfBatch) is called for every available slot;
+  // waits if nothing is available and returns how many slots were processed
+  template <typename HandlerT>
+  size_t process(HandlerT&& handler)
+  {
+    const int64_t next = mSequence.load() + 1;
+    const int64_t available = mBarrier.wait_for(next);
+    if (available < next)
+      return 0;
+
+    for (int64_t sequence = next; sequence <= available; ++sequence)
+      handler((*mRing)[sequence], sequence, sequence == available);
+    // one store releases the whole batch to the consumers behind us and to the writer
+    mSequence.store(available);
+    return static_cast<size_t>(available - next + 1);
+  }
+
+  // processes until every sequence up to and including last has been handled
+  template <typename HandlerT>
+  void process_until(int64_t last, HandlerT&& handler)
+  {
+    while (mSequence.load() < last && !mRing->halted())
+      process(handler);
+  }
+};
+
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <containers/circular_buffer/include/circular_buffer.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace regit::containers {
+
+// Rolling window over the last capacity() samples that answers rank and quantile queries
+// in O(log n). Next to the CircularBuffer holding the samples in arrival order, every sample
+// also lives in a treap ordered by (value, arrival sequence) whose nodes track their subtree
+// sizes. The nodes are preallocated in a pool sized to the window, so pushing never allocates.
+template <typename T>
+class OrderStatisticsWindow
+{
+  using index_t = uint32_t;
+  static constexpr index_t NIL = 0;
+
+  struct Node
+  {
+    T Value;
+    uint64_t Sequence;
+    uint32_t Priority;
+    index_t Left, Right;
+    index_t Size;
+  };
+
+  CircularBuffer<T> mWindow;
+  std::vector<Node> mNodes;
+  std::vector<index_t> mFree;
+  index_t mRoot;
+  uint64_t mPushed;
+  uint32_t mSeed;
+
+  uint32_t NextPriority() noexcept
+  {
+    // xorshift32
+    mSeed ^= mSeed << 13;
+    mSeed ^= mSeed >> 17;
+    mSeed ^= mSeed << 5;
+    return mSeed;
+  }
+
+  bool Less(const T& value, uint64_t sequence, const Node& node) const noexcept
+  {
+    return value < node.Value || (!(node.Value < value) && sequence < node.Sequence);
+  }
+
+  void Update(index_t node) noexcept
+  {
+    Node& n = mNodes[node];
+    n.Size = 1 + mNodes[n.Left].Size + mNodes[n.Right].Size;
+  }
+
+  // splits into keys ordered before (value, sequence) and the rest
+  void Split(index_t node, const T& value, uint64_t sequence, index_t& left, index_t& right) noexcept
+  {
+    if (node == NIL)
+    {
+      left = right = NIL;
+      return;
+    }
+
+    Node& n = mNodes[node];
+    if (Less(value, sequence, n))
+    {
+      Split(n.Left, value, sequence, left, n.Left);
+      right = node;
+    }
+    else
+    {
+      Split(n.Right, value, sequence, n.Right, right);
+      left = node;
+    }
+    Update(node);
+  }
+
+  index_t Merge(index_t left, index_t right) noexcept
+  {
+    if (left == NIL || right == NIL)
+      return left == NIL ? right : left;
+
+    if (mNodes[left].Priority > mNodes[right].Priority)
+    {
+      mNodes[left].Right = Merge(mNodes[left].Right, right);
+      Update(left);
+      return left;
+    }
+    mNodes[right].Left = Merge(left, mNodes[right].Left);
+    Update(right);
+    return right;
+  }
+
+  index_t Erase(index_t node, const T& value, uint64_t sequence) noexcept
+  {
+    Node& n = mNodes[node];
+    if (n.Sequence == sequence)
+    {
+      mFree.push_back(node);
+      return Merge(n.Left, n.Right);
+    }
+
+    if (Less(value, sequence, n))
+      n.Left = Erase(n.Left, value, sequence);
+    else
+      n.Right = Erase(n.Right, value, sequence);
+    Update(node);
+    return node;
+  }
+
+  void Insert(const T& value, uint64_t sequence)
+  {
+    index_t node = mFree.back();
+    mFree.pop_back();
+    mNodes[node] = Node{ value, sequence, NextPriority(), NIL, NIL, 1 };
+
+    index_t left, right;
+    Split(mRoot, value, sequence, left, right);
+    mRoot = Merge(Merge(left, node), right);
+  }
+
+public:
+  // a window of 0 is clamped to 1, pushing always has a sample to evict
+  explicit OrderStatisticsWindow(size_t window)
+    : mWindow(window ? window : 1), mNodes(mWindow.capacity() + 1), mFree(), mRoot{ NIL }, mPushed{ 0 },
+      mSeed{ 2463534242u }
+  {
+    mNodes[NIL].Size = 0;
+    mFree.reserve(mWindow.capacity());
+    for (size_t i = mWindow.capacity(); i != 0; --i)
+      mFree.push_back(static_cast<index_t>(i));
+  }
+
+  void push(const T& value)
+  {
+    if (mWindow.size() == mWindow.capacity())
+    {
+      mRoot = Erase(mRoot, mWindow.front(), mPushed - mWindow.capacity());
+      mWindow.pop_front();
+    }
+
+    mWindow.push(value);
+    Insert(value, mPushed);
+    ++mPushed;
+  }
+
+  void emplace(const T& value)
+  {
+    push(value);
+  }
+
+  void clear()
+  {
+    mWindow.clear();
+    mFree.clear();
+    for (size_t i = mNodes.size() - 1; i != 0; --i)
+      mFree.push_back(static_cast<index_t>(i));
+    mRoot = NIL;
+  }
+
+  size_t size() const noexcept
+  {
+    return mWindow.size();
+  }
+
+  bool empty() const noexcept
+  {
+    return mWindow.empty();
+  }
+
+  size_t capacity() const noexcept
+  {
+    return mWindow.capacity();
+  }
+
+  // k-th smallest sample (0-based)
+  const T& select(size_t k) const
+  {
+    if (k >= size())
+      throw std::out_of_range{ "rank out of bounds!" };
+
+    index_t node = mRoot;
+    for (;;)
+    {
+      const Node& n = mNodes[node];
+      size_t leftSize = mNodes[n.Left].Size;
+      if (k < leftSize)
+        node = n.Left;
+      else if (k == leftSize)
+        return n.Value;
+      else
+      {
+        k -= leftSize + 1;
+        node = n.Right;
+      }
+    }
+  }
+
+  // nearest-rank quantile, q in [0, 1]
+  const T& quantile(double q) const
+  {
+    if (empty())
+      throw std::out_of_range{ "quantile of an empty window!" };
+    if (q <= 0.0)
+      return select(0);
+    if (q >= 1.0)
+      return select(size() - 1);
+    return select(static_cast<size_t>(q * static_cast<double>(size() - 1) + 0.5));
+  }
+
+  const T& median() const
+  {
+    return quantile(0.5);
+  }
+
+  // number of samples strictly less than value
+  size_t rank(const T& value) const noexcept
+  {
+    size_t result = 0;
+    index_t node = mRoot;
+    while (node != NIL)
+    {
+      const Node& n = mNodes[node];
+      if (n.Value < value)
+      {
+        result += mNodes[n.Left].Size + 1;
+        node = n.Right;
+      }
+      else
+        node = n.Left;
+    }
+    return result;
+  }
+
+  const CircularBuffer<T>& window() const noexcept
+  {
+    return mWindow;
+  }
+};
+
+}
@@ -0,0 +1,387 @@
+#pragma once
+
+#include <containers/common/include/system_error.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace regit::containers {
+
+struct JournalSyncPolicy
+{
+  enum class Mode
+  {
+    None,       // leave write-back entirely to the kernel
+    Async,      // msync(MS_ASYNC): schedule write-back, do not wait for it
+    Sync,       // msync(MS_SYNC) on the dirty records, then on the header
+    DataSync    // fdatasync on the file, before and after the header update
+  };
+
+  Mode SyncMode = Mode::Sync;
+  // sync after this many pushes, 0 only syncs on sync() and on destruction
+  size_t Every = 0;
+};
+
+// File-backed CircularBuffer for trivially copyable T.
+// The file starts with a header page holding the capacity and the head/tail sequences as of
+// the last sync, followed by capacity() record slots. Every record stores its sequence number
+// and a checksum over sequence and payload, so on reopen the ring recovers the last
+// consistent state: it rolls forward over valid records written after the last sync and drops
+// records that were torn by a crash. Between sync points pushes are plain memory writes.
+template <typename T>
+class PersistentCircularBuffer
+{
+  static_assert(std::is_trivially_copyable_v<T>, "PersistentCircularBuffer requires a trivially copyable T");
+
+  static constexpr uint64_t MAGIC = 0x4c4e524a54494752ull; // "RGITJRNL"
+  static constexpr uint32_t VERSION = 1;
+
+  struct Header
+  {
+    uint64_t Magic;
+    uint32_t Version;
+    uint32_t RecordSize;
+    uint64_t Capacity;
+    uint64_t Head;
+    uint64_t Tail;
+    uint64_t Checksum;
+  };
+
+  struct Record
+  {
+    uint64_t Sequence;
+    uint64_t Checksum;
+    T Payload;
+  };
+
+  // FNV-1a
+  static uint64_t Checksum(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull) noexcept
+  {
+    auto bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i != size; ++i)
+    {
+      hash ^= bytes[i];
+      hash *= 0x100000001b3ull;
+    }
+    return hash;
+  }
+
+  static uint64_t RecordChecksum(const Record& record) noexcept
+  {
+    return Checksum(&record.Payload, sizeof(T), Checksum(&record.Sequence, sizeof(record.Sequence)));
+  }
+
+  static uint64_t HeaderChecksum(const Header& header) noexcept
+  {
+    return Checksum(&header, offsetof(Header, Checksum));
+  }
+
+  int mFd;
+  size_t mPage;
+  size_t mCap;
+  size_t mFileSize;
+  char* mMapping;
+  Header* mHeader;
+  Record* mRecords;
+  JournalSyncPolicy mPolicy;
+
+  uint64_t mHead, mTail;
+  uint64_t mSyncedTail;
+  size_t mUnsynced;
+
+  Record& slot(uint64_t sequence) const noexcept
+  {
+    return mRecords[sequence % mCap];
+  }
+
+  bool RecordValid(uint64_t sequence) const noexcept
+  {
+    const Record& record = slot(sequence);
+    return record.Sequence == sequence && record.Checksum == RecordChecksum(record);
+  }
+
+  void MapFile(const std::string& path)
+  {
+    mFd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (mFd == -1)
+      detail::ThrowSystemError("open failed");
+
+    struct stat info;
+    if (fstat(mFd, &info) == -1)
+      detail::ThrowSystemError("fstat failed");
+
+    const bool created = info.st_size == 0;
+    if (created && ftruncate(mFd, static_cast<off_t>(mFileSize)) == -1)
+      detail::ThrowSystemError("ftruncate failed");
+    if (!created && static_cast<size_t>(info.st_size) != mFileSize)
+      throw std::runtime_error{ "journal size does not match the requested capacity" };
+
+    void* mapping = mmap(nullptr, mFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+    if (mapping == MAP_FAILED)
+      detail::ThrowSystemError("mmap failed");
+
+    mMapping = static_cast<char*>(mapping);
+    mHeader = reinterpret_cast<Header*>(mMapping);
+    mRecords = reinterpret_cast<Record*>(mMapping + mPage);
+
+    if (created)
+    {
+      *mHeader = Header{ MAGIC, VERSION, static_cast<uint32_t>(sizeof(Record)), mCap, 0, 0, 0 };
+      mHeader->Checksum = HeaderChecksum(*mHeader);
+      return;
+    }
+
+    if (mHeader->Magic != MAGIC || mHeader->Version != VERSION
+      || mHeader->RecordSize != sizeof(Record) || mHeader->Capacity != mCap)
+      throw std::runtime_error{ "journal was written with a different layout" };
+    Recover();
+  }
+
+  void Recover() noexcept
+  {
+    if (mHeader->Checksum != HeaderChecksum(*mHeader)
+      || (mHeader->Tail != mHeader->Head && !RecordValid(mHeader->Tail - 1)))
+    {
+      // the header itself cannot be trusted, fall back to scanning every slot
+      FullScan();
+      return;
+    }
+
+    mHead = mHeader->Head;
+    mTail = mHeader->Tail;
+
+    // roll forward over records that reached the file after the last sync
+    while (RecordValid(mTail))
+      ++mTail;
+    if (mTail - mHead > mCap)
+      mHead = mTail - mCap;
+    // a torn write of the newest record may have destroyed the oldest one
+    while (mHead != mTail && !RecordValid(mHead))
+      ++mHead;
+  }
+
+  void FullScan() noexcept
+  {
+    bool found = false;
+    uint64_t newest = 0;
+    for (size_t i = 0; i != mCap; ++i)
+    {
+      const Record& record = mRecords[i];
+      if (record.Sequence % mCap == i && record.Checksum == RecordChecksum(record)
+        && (!found || record.Sequence > newest))
+      {
+        newest = record.Sequence;
+        found = true;
+      }
+    }
+
+    mHead = mTail = found ? newest + 1 : 0;
+    while (mHead != 0 && mTail - mHead < mCap && RecordValid(mHead - 1))
+      --mHead;
+  }
+
+  void Flush(void* address, size_t length, int flags)
+  {
+    // msync needs a page aligned start
+    auto start = reinterpret_cast<uintptr_t>(address);
+    uintptr_t aligned = start & ~(mPage - 1);
+    if (msync(reinterpret_cast<void*>(aligned), length + (start - aligned), flags) == -1)
+      detail::ThrowSystemError("msync failed");
+  }
+
+  void FlushRecords(int flags)
+  {
+    if (mSyncedTail == mTail)
+      return;
+
+    uint64_t first = mSyncedTail;
+    if (mTail - first > mCap)
+      first = mTail - mCap;
+    size_t begin = first % mCap;
+    size_t count = mTail - first;
+    size_t firstPart = count < mCap - begin ? count : mCap - begin;
+
+    Flush(mRecords + begin, sizeof(Record) * firstPart, flags);
+    if (count != firstPart)
+      Flush(mRecords, sizeof(Record) * (count - firstPart), flags);
+  }
+
+  void WriteHeader() noexcept
+  {
+    mHeader->Head = mHead;
+    mHeader->Tail = mTail;
+    mHeader->Checksum = HeaderChecksum(*mHeader);
+  }
+
+public:
+  PersistentCircularBuffer(const std::string& path, size_t capacity, JournalSyncPolicy policy = { })
+    : mFd{ -1 }, mPage{ static_cast<size_t>(sysconf(_SC_PAGESIZE)) }, mCap{ capacity ? capacity : 1 },
+      mFileSize{ mPage + sizeof(Record) * mCap }, mMapping{ nullptr }, mHeader{ nullptr },
+      mRecords{ nullptr }, mPolicy{ policy }, mHead{ 0 }, mTail{ 0 }, mSyncedTail{ 0 }, mUnsynced{ 0 }
+  {
+    try
+    {
+      MapFile(path);
+    }
+    catch (...)
+    {
+      if (mMapping)
+        munmap(mMapping, mFileSize);
+      if (mFd != -1)
+        close(mFd);
+      throw;
+    }
+    mSyncedTail = mTail;
+  }
+
+  PersistentCircularBuffer(const PersistentCircularBuffer&) = delete;
+  PersistentCircularBuffer(PersistentCircularBuffer&&) = delete;
+  PersistentCircularBuffer& operator=(const PersistentCircularBuffer&) = delete;
+  PersistentCircularBuffer& operator=(PersistentCircularBuffer&&) = delete;
+
+  ~PersistentCircularBuffer()
+  {
+    try
+    {
+      sync();
+    }
+    catch (const std::exception&)
+    {
+      // nothing sensible left to do, the next open recovers from the records
+    }
+    munmap(mMapping, mFileSize);
+    close(mFd);
+  }
+
+  // appends value, overwriting the oldest record once the ring is full
+  void push(const T& value)
+  {
+    // a record torn by a crash fails its checksum and is dropped on recovery
+    Record& record = slot(mTail);
+    memcpy(&record.Payload, &value, sizeof(T));
+    record.Sequence = mTail;
+    record.Checksum = RecordChecksum(record);
+
+    ++mTail;
+    if (mTail - mHead > mCap)
+      mHead = mTail - mCap;
+
+    if (mPolicy.Every && ++mUnsynced >= mPolicy.Every)
+      sync();
+  }
+
+  template <typename ... Args>
+  void emplace(Args&& ... args)
+  {
+    push(T{ std::forward<Args>(args)... });
+  }
+
+  // marks the oldest record as consumed
+  void pop_front() noexcept
+  {
+    if (mHead != mTail)
+      ++mHead;
+  }
+
+  void clear() noexcept
+  {
+    mHead = mTail;
+  }
+
+  // makes every push so far durable according to the sync policy
+  void sync()
+  {
+    mUnsynced = 0;
+    switch (mPolicy.SyncMode)
+    {
+    case JournalSyncPolicy::Mode::None:
+      WriteHeader();
+      break;
+    case JournalSyncPolicy::Mode::Async:
+      FlushRecords(MS_ASYNC);
+      WriteHeader();
+      Flush(mHeader, sizeof(Header), MS_ASYNC);
+      break;
+    case JournalSyncPolicy::Mode::Sync:
+      // records must be on disk before the header may point at them
+      FlushRecords(MS_SYNC);
+      WriteHeader();
+      Flush(mHeader, sizeof(Header), MS_SYNC);
+      break;
+    case JournalSyncPolicy::Mode::DataSync:
+      if (mSyncedTail != mTail && fdatasync(mFd) == -1)
+        detail::ThrowSystemError("fdatasync failed");
+      WriteHeader();
+      if (fdatasync(mFd) == -1)
+        detail::ThrowSystemError("fdatasync failed");
+      break;
+    }
+    mSyncedTail = mTail;
+  }
+
+  size_t size() const noexcept
+  {
+    return mTail - mHead;
+  }
+
+  bool empty() const noexcept
+  {
+    return mTail == mHead;
+  }
+
+  size_t capacity() const noexcept
+  {
+    return mCap;
+  }
+
+  // sequence number of front(), every push gets the next one
+  uint64_t front_sequence() const noexcept
+  {
+    return mHead;
+  }
+
+  uint64_t next_sequence() const noexcept
+  {
+    return mTail;
+  }
+
+  const T& operator[](size_t index) const noexcept
+  {
+    return slot(mHead + index).Payload;
+  }
+
+  const T& at(size_t index) const
+  {
+    if (index >= size())
+      throw std::out_of_range{ "array out of bounds!" };
+    return operator[](index);
+  }
+
+  const T& front() const noexcept
+  {
+    return slot(mHead).Payload;
+  }
+
+  const T& back() const noexcept
+  {
+    return slot(mTail - 1).Payload;
+  }
+
+  using value_type = T;
+  using size_type = size_t;
+  using const_reference = const T&;
+};
+
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <containers/common/include/ring_utility.hpp>
+#include <containers/common/include/seqlock_slot.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace regit::containers {
+
+// Single-writer overwrite ring that any number of reader threads can read without ever
+// holding up the writer. Every slot carries the sequence number of the element it holds
+// (0 while it is being rewritten) and the tail publishes the next sequence, so a reader
+// copies a slot optimistically and afterwards checks that the writer did not touch it in
+// the meantime. push is wait-free; readers retry or skip what the writer overran.
+template <typename T>
+class SeqlockCircularBuffer
+{
+  static_assert(std::is_trivially_copyable_v<T>, "SeqlockCircularBuffer requires a trivially copyable T");
+
+  using Slot = detail::SeqlockSlot<T>;
+
+  size_t mCap;
+  size_t mMask;
+  std::unique_ptr<Slot[]> mSlots;
+  alignas(64) std::atomic<uint64_t> mTail;
+  // writer only, kept off the line the readers poll
+  alignas(64) uint64_t mNext;
+
+public:
+  // capacity is rounded up to a power of two
+  explicit SeqlockCircularBuffer(size_t size)
+    : mCap{ detail::RoundUpPowerOfTwo(size) }, mMask{ mCap - 1 }, mSlots{ new Slot[mCap] }, mTail{ 0 }, mNext{ 0 }
+  {
+    for (size_t i = 0; i != mCap; ++i)
+      mSlots[i].Sequence.store(0, std::memory_order_relaxed);
+  }
+
+  SeqlockCircularBuffer(const SeqlockCircularBuffer&) = delete;
+  SeqlockCircularBuffer& operator=(const SeqlockCircularBuffer&) = delete;
+
+  // writer: appends value, overwriting the oldest element once the ring is full
+  void push(const T& value) noexcept
+  {
+    mSlots[mNext & mMask].Write(mNext, value);
+    ++mNext;
+    mTail.store(mNext, std::memory_order_release);
+  }
+
+  template <typename ... Args>
+  void emplace(Args&& ... args) noexcept
+  {
+    push(T{ std::forward<Args>(args)... });
+  }
+
+  // copies the element with the given sequence; false if it was not published yet,
+  // has been overwritten or was being overwritten while it was copied
+  bool try_read(uint64_t sequence, T& value) const noexcept
+  {
+    if (sequence >= mTail.load(std::memory_order_acquire))
+      return false;
+    return mSlots[sequence & mMask].TryRead(sequence, value);
+  }
+
+  // copies the newest element, false only if nothing was pushed yet
+  bool latest(T& value) const noexcept
+  {
+    for (;;)
+    {
+      const uint64_t tail = mTail.load(std::memory_order_acquire);
+      if (!tail)
+        return false;
+      // only fails if the writer lapped the whole ring while we were copying
+      if (try_read(tail - 1, value))
+        return true;
+    }
+  }
+
+  // copies up to count of the newest elements into out, oldest first, and returns how many
+  // it copied. Elements the writer overran during the copy are left out, so the result is
+  // always a run of consecutive sequences ending at the newest element seen on entry.
+  size_t read_latest(T* out, size_t count) const noexcept
+  {
+    const uint64_t tail = mTail.load(std::memory_order_acquire);
+    count = std::min<uint64_t>({ count, tail, mCap });
+
+    // newest first, the writer reaches the oldest slots first
+    size_t copied = 0;
+    while (copied != count && try_read(tail - 1 - copied, out[count - 1 - copied]))
+      ++copied;
+
+    if (copied != count)
+      std::memmove(out, out + (count - copied), sizeof(T) * copied);
+    return copied;
+  }
+
+  // sequence the next push gets, i.e. the number of elements pushed so far
+  uint64_t next_sequence() const noexcept
+  {
+    return mTail.load(std::memory_order_acquire);
+  }
+
+  // sequence of the oldest element still in the ring
+  uint64_t front_sequence() const noexcept
+  {
+    const uint64_t tail = next_sequence();
+    return tail > mCap ? tail - mCap : 0;
+  }
+
+  size_t size() const noexcept
+  {
+    return std::min<uint64_t>(next_sequence(), mCap);
+  }
+
+  bool empty() const noexcept
+  {
+    return next_sequence() == 0;
+  }
+
+  size_t capacity() const noexcept
+  {
+    return mCap;
+  }
+};
+
+}
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <containers/common/include/seqlock_slot.hpp>
+#include <containers/common/include/system_error.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#if !defined(__linux__)
+#error "SharedCircularBuffer relies on futexes and is only available on Linux"
+#endif
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace regit::containers {
+
+namespace detail
+{
+  // Layout of the shared segment. Everything is addressed relative to the start of the
+  // mapping, so each process may map it at a different address.
+  struct SharedRingHeader
+  {
+    static constexpr uint64_t MAGIC = 0x474e495248544752ull; // "RGTHRING"
+
+    uint64_t Magic;
+    uint64_t Capacity;
+    uint64_t SlotSize;
+    uint64_t SlotsOffset;
+
+    // sequence of the next element the writer publishes
+    alignas(64) std::atomic<uint64_t> Tail;
+
+    // readers park on Signal; the writer only bumps it when Waiters says someone is parked
+    alignas(64) std::atomic<uint32_t> Signal;
+    std::atomic<uint32_t> Waiters;
+  };
+
+  inline long Futex(std::atomic<uint32_t>* address, int operation, uint32_t value, const timespec* timeout) noexcept
+  {
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+    // not FUTEX_PRIVATE_FLAG, waiters and wakers live in different processes
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), operation, value, timeout, nullptr, 0);
+  }
+
+  class SharedMapping
+  {
+  public:
+    SharedMapping(const std::string& name, int flags, size_t size)
+      : mFd{ shm_open(name.c_str(), flags | O_CLOEXEC, 0600) }, mSize{ size }, mAddress{ nullptr }
+    {
+      if (mFd == -1)
+        ThrowSystemError("shm_open failed");
+
+      if (flags & O_CREAT)
+      {
+        if (ftruncate(mFd, static_cast<off_t>(mSize)) == -1)
+          Fail("ftruncate failed");
+      }
+      else
+      {
+        struct stat info;
+        if (fstat(mFd, &info) == -1)
+          Fail("fstat failed");
+        mSize = static_cast<size_t>(info.st_size);
+      }
+
+      void* address = mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+      if (address == MAP_FAILED)
+        Fail("mmap failed");
+      mAddress = static_cast<char*>(address);
+    }
+
+    SharedMapping(const SharedMapping&) = delete;
+    SharedMapping& operator=(const SharedMapping&) = delete;
+
+    ~SharedMapping()
+    {
+      munmap(mAddress, mSize);
+      close(mFd);
+    }
+
+    char* address() const noexcept
+    {
+      return mAddress;
+    }
+
+    size_t size() const noexcept
+    {
+      return mSize;
+    }
+
+  private:
+    [[noreturn]] void Fail(const char* what)
+    {
+      int error = errno;
+      close(mFd);
+      errno = error;
+      ThrowSystemError(what);
+    }
+
+    int mFd;
+    size_t mSize;
+    char* mAddress;
+  };
+
+} // detail namespace
+
+// Writing end of a shm_open/mmap backed ring shared between processes.
+// Like CircularBuffer, a push always succeeds and overwrites the oldest element once the ring
+// is full; the writer never waits for readers. The segment is removed when the writer goes away,
+// readers that already mapped it keep working until they unmap it.
+// Only one writer may own a segment: creating one whose name exists throws EEXIST, a segment
+// left behind by a writer that crashed has to be removed with shm_unlink first.
+template <typename T>
+class SharedCircularBufferWriter
+{
+  static_assert(std::is_trivially_copyable_v<T>, "SharedCircularBuffer requires a trivially copyable T");
+
+  using header_t = detail::SharedRingHeader;
+  using slot_t = detail::SeqlockSlot<T>;
+
+  static constexpr size_t SLOTS_OFFSET = (sizeof(header_t) + 63) / 64 * 64;
+
+  std::string mName;
+  detail::SharedMapping mMapping;
+  header_t* mHeader;
+  slot_t* mSlots;
+  size_t mCap;
+  uint64_t mTail;
+
+public:
+  // name follows shm_open rules, e.g. "/feed_ticks"
+  SharedCircularBufferWriter(std::string name, size_t capacity)
+    : mName{ std::move(name) },
+      mMapping{ mName, O_CREAT | O_EXCL | O_RDWR, SLOTS_OFFSET + sizeof(slot_t) * (capacity ? capacity : 1) },
+      mHeader{ reinterpret_cast<header_t*>(mMapping.address()) },
+      mSlots{ reinterpret_cast<slot_t*>(mMapping.address() + SLOTS_OFFSET) },
+      mCap{ capacity ? capacity : 1 }, mTail{ 0 }
+  {
+    new (mHeader) header_t{ 0, mCap, sizeof(slot_t), SLOTS_OFFSET, { 0 }, { 0 }, { 0 } };
+    for (size_t i = 0; i != mCap; ++i)
+      new (&mSlots[i].Sequence) std::atomic<uint64_t>{ 0 };
+    // readers refuse to attach until the layout is complete
+    std::atomic_thread_fence(std::memory_order_release);
+    mHeader->Magic = header_t::MAGIC;
+  }
+
+  SharedCircularBufferWriter(const SharedCircularBufferWriter&) = delete;
+  SharedCircularBufferWriter& operator=(const SharedCircularBufferWriter&) = delete;
+
+  ~SharedCircularBufferWriter()
+  {
+    shm_unlink(mName.c_str());
+  }
+
+  void push(const T& value) noexcept
+  {
+    // readers that raced with this write see the sequence change and retry
+    mSlots[mTail % mCap].Write(mTail, value);
+    ++mTail;
+    mHeader->Tail.store(mTail, std::memory_order_seq_cst);
+    if (mHeader->Waiters.load(std::memory_order_seq_cst))
+    {
+      mHeader->Signal.fetch_add(1, std::memory_order_seq_cst);
+      detail::Futex(&mHeader->Signal, FUTEX_WAKE, INT_MAX, nullptr);
+    }
+  }
+
+  template <typename ... Args>
+  void emplace(Args&& ... args) noexcept
+  {
+    push(T{ std::forward<Args>(args)... });
+  }
+
+  size_t capacity() const noexcept
+  {
+    return mCap;
+  }
+
+  uint64_t next_sequence() const noexcept
+  {
+    return mTail;
+  }
+
+  const std::string& name() const noexcept
+  {
+    return mName;
+  }
+};
+
+// Reading end of a SharedCircularBufferWriter ring. Every reader keeps its own cursor, so
+// any number of readers (in any number of processes) see every element. A reader that falls
+// more than capacity() elements behind skips ahead to the oldest element still available
+// and counts the elements it lost in lapped().
+template <typename T>
+class SharedCircularBufferReader
+{
+  static_assert(std::is_trivially_copyable_v<T>, "SharedCircularBuffer requires a trivially copyable T");
+
+  using header_t = detail::SharedRingHeader;
+  using slot_t = detail::SeqlockSlot<T>;
+
+  detail::SharedMapping mMapping;
+  header_t* mHeader;
+  slot_t* mSlots;
+  size_t mCap;
+  uint64_t mCursor;
+  uint64_t mLapped;
+
+  // blocks until the tail moves past the cursor or the deadline passes
+  bool Wait(const timespec* timeout) noexcept
+  {
+    mHeader->Waiters.fetch_add(1, std::memory_order_seq_cst);
+    const uint32_t signal = mHeader->Signal.load(std::memory_order_seq_cst);
+    bool ready = mHeader->Tail.load(std::memory_order_seq_cst) != mCursor;
+    if (!ready)
+    {
+      long result = detail::Futex(&mHeader->Signal, FUTEX_WAIT, signal, timeout);
+      ready = !(result == -1 && errno == ETIMEDOUT);
+    }
+    mHeader->Waiters.fetch_sub(1, std::memory_order_seq_cst);
+    return ready;
+  }
+
+public:
+  enum class Start
+  {
+    Oldest,   // everything still in the ring
+    Latest    // only elements pushed from now on
+  };
+
+  explicit SharedCircularBufferReader(const std::string& name, Start start = Start::Oldest)
+    : mMapping{ name, O_RDWR, 0 },
+      mHeader{ reinterpret_cast<header_t*>(mMapping.address()) },
+      mSlots{ nullptr }, mCap{ 0 }, mCursor{ 0 }, mLapped{ 0 }
+  {
+    if (mMapping.size() < sizeof(header_t) || mHeader->Magic != header_t::MAGIC
+      || mHeader->SlotSize != sizeof(slot_t)
+      || mMapping.size() < mHeader->SlotsOffset + mHeader->SlotSize * mHeader->Capacity)
+      throw std::runtime_error{ "shared segment is not a compatible SharedCircularBuffer" };
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    mSlots = reinterpret_cast<slot_t*>(mMapping.address() + mHeader->SlotsOffset);
+    mCap = mHeader->Capacity;
+    const uint64_t tail = mHeader->Tail.load(std::memory_order_acquire);
+    if (start == Start::Latest)
+      mCursor = tail;
+    else
+      mCursor = tail > mCap ? tail - mCap : 0;
+  }
+
+  SharedCircularBufferReader(const SharedCircularBufferReader&) = delete;
+  SharedCircularBufferReader& operator=(const SharedCircularBufferReader&) = delete;
+
+  bool try_pop(T& value) noexcept
+  {
+    for (;;)
+    {
+      const uint64_t tail = mHeader->Tail.load(std::memory_order_acquire);
+      if (mCursor == tail)
+        return false;
+      if (tail - mCursor > mCap)
+      {
+        mLapped += tail - mCap - mCursor;
+        mCursor = tail - mCap;
+      }
+
+      if (mSlots[mCursor % mCap].TryRead(mCursor, value))
+      {
+        ++mCursor;
+        return true;
+      }
+      // the writer lapped us while we were copying, skip ahead and try again
+      ++mLapped;
+      ++mCursor;
+    }
+  }
+
+  // blocks on a futex while the ring is empty
+  void pop(T& value) noexcept
+  {
+    while (!try_pop(value))
+      Wait(nullptr);
+  }
+
+  // returns false if nothing arrived before the timeout
+  template <typename Rep, typename Period>
+  bool pop(T& value, std::chrono::duration<Rep, Period> timeout) noexcept
+  {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!try_pop(value))
+    {
+      auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now());
+      if (remaining.count() <= 0)
+        return false;
+      timespec relative{ static_cast<time_t>(remaining.count() / 1'000'000'000),
+        static_cast<long>(remaining.count() % 1'000'000'000) };
+      Wait(&relative);
+    }
+    return true;
+  }
+
+  // elements published but not read yet (may include some that will be lapped)
+  size_t available() const noexcept
+  {
+    return mHeader->Tail.load(std::memory_order_acquire) - mCursor;
+  }
+
+  bool empty() const noexcept
+  {
+    return available() == 0;
+  }
+
+  size_t capacity() const noexcept
+  {
+    return mCap;
+  }
+
+  uint64_t lapped() const noexcept
+  {
+    return mLapped;
+  }
+};
+
+}
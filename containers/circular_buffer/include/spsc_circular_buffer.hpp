@@ -0,0 +1,151 @@
+#pragma once
+
+#include <containers/common/include/ring_utility.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace regit::containers {
+
+// Lock-free single-producer/single-consumer ring.
+// Exactly one thread may call the producer functions (try_push, try_emplace) and exactly one
+// thread may call the consumer functions (try_pop, front, pop). Indices are free running and
+// wrapped with a mask, so the capacity is rounded up to the next power of two.
+template <typename T, typename Allocator = std::allocator<T>>
+class SpscCircularBuffer
+{
+  static constexpr size_t CACHE_LINE = 64;
+
+  // read-only after construction, shared by both sides
+  Allocator mAlloc;
+  size_t mCap;
+  size_t mMask;
+  T* mBuffer;
+
+  // consumer side: its own index and the last tail it has seen
+  alignas(CACHE_LINE) std::atomic<size_t> mHead;
+  size_t mCachedTail;
+
+  // producer side: its own index and the last head it has seen
+  alignas(CACHE_LINE) std::atomic<size_t> mTail;
+  size_t mCachedHead;
+
+public:
+  explicit SpscCircularBuffer(size_t size = 1)
+    : mAlloc{ }, mCap{ detail::RoundUpPowerOfTwo(size) }, mMask{ mCap - 1 },
+      mBuffer{ mAlloc.allocate(mCap) }, mHead{ 0 }, mCachedTail{ 0 },
+      mTail{ 0 }, mCachedHead{ 0 }
+  { }
+
+  SpscCircularBuffer(const SpscCircularBuffer&) = delete;
+  SpscCircularBuffer(SpscCircularBuffer&&) = delete;
+  SpscCircularBuffer& operator=(const SpscCircularBuffer&) = delete;
+  SpscCircularBuffer& operator=(SpscCircularBuffer&&) = delete;
+
+  ~SpscCircularBuffer()
+  {
+    if constexpr (!std::is_trivially_destructible_v<T>)
+    {
+      size_t tail = mTail.load(std::memory_order_relaxed);
+      for (size_t head = mHead.load(std::memory_order_relaxed); head != tail; ++head)
+        mBuffer[head & mMask].~T();
+    }
+    mAlloc.deallocate(mBuffer, mCap);
+    mBuffer = nullptr;
+  }
+
+  // producer
+  template <typename ... Args>
+  bool try_emplace(Args&& ... args)
+  {
+    const size_t tail = mTail.load(std::memory_order_relaxed);
+    if (tail - mCachedHead == mCap)
+    {
+      // only touch the consumer's line when the cached view says we are full
+      mCachedHead = mHead.load(std::memory_order_acquire);
+      if (tail - mCachedHead == mCap)
+        return false;
+    }
+
+    new (mBuffer + (tail & mMask)) T{ std::forward<Args>(args)... };
+    mTail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_push(const T& value)
+  {
+    return try_emplace(value);
+  }
+
+  bool try_push(T&& value)
+  {
+    return try_emplace(std::move(value));
+  }
+
+  // consumer
+  T* front() noexcept
+  {
+    const size_t head = mHead.load(std::memory_order_relaxed);
+    if (head == mCachedTail)
+    {
+      mCachedTail = mTail.load(std::memory_order_acquire);
+      if (head == mCachedTail)
+        return nullptr;
+    }
+    return mBuffer + (head & mMask);
+  }
+
+  // must only be called after front() returned a non-null element
+  void pop() noexcept
+  {
+    const size_t head = mHead.load(std::memory_order_relaxed);
+    mBuffer[head & mMask].~T();
+    mHead.store(head + 1, std::memory_order_release);
+  }
+
+  bool try_pop(T& value)
+  {
+    T* element = front();
+    if (!element)
+      return false;
+    value = std::move(*element);
+    pop();
+    return true;
+  }
+
+  // approximate when called while the other side is active
+  size_t size() const noexcept
+  {
+    // head first so that the tail we read can never be behind it
+    const size_t head = mHead.load(std::memory_order_acquire);
+    return mTail.load(std::memory_order_acquire) - head;
+  }
+
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  size_t capacity() const noexcept
+  {
+    return mCap;
+  }
+
+  Allocator get_allocator() const noexcept
+  {
+    return mAlloc;
+  }
+
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+};
+
+}
@@ -0,0 +1,389 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace regit::containers {
+
+// CircularBuffer with a compile-time capacity and inline storage.
+// Nothing is heap allocated, and when N is a power of two every wrap is a single mask.
+// Like CircularBuffer, push/emplace overwrite the oldest element once the ring is full
+// and pop removes the newest element.
+template <typename T, size_t N>
+class StaticCircularBuffer
+{
+  static_assert(N > 0, "StaticCircularBuffer needs a non-zero capacity");
+
+  static constexpr bool POWER_OF_TWO = (N & (N - 1)) == 0;
+
+  static constexpr size_t Wrap(size_t index) noexcept
+  {
+    if constexpr (POWER_OF_TWO)
+      return index & (N - 1);
+    else
+      return index % N;
+  }
+
+  alignas(T) unsigned char mStorage[sizeof(T) * N];
+  size_t mStart;
+  size_t mSize;
+
+  T* slot(size_t index) noexcept
+  {
+    return std::launder(reinterpret_cast<T*>(mStorage) + index);
+  }
+
+  const T* slot(size_t index) const noexcept
+  {
+    return std::launder(reinterpret_cast<const T*>(mStorage) + index);
+  }
+
+public:
+
+  template <typename BufferT, typename T1>
+  class Iterator
+  {
+    BufferT* mBuffer;
+    size_t mIndex;
+
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = std::remove_const_t<T1>;
+    using pointer = T1*;
+    using reference = T1&;
+
+    Iterator(BufferT* buffer, size_t index) noexcept
+      : mBuffer{ buffer }, mIndex{ index }
+    { }
+
+    reference operator*() const noexcept
+    {
+      return (*mBuffer)[mIndex];
+    }
+
+    pointer operator->() const noexcept
+    {
+      return &(*mBuffer)[mIndex];
+    }
+
+    reference operator[](difference_type pos) const noexcept
+    {
+      return (*mBuffer)[mIndex + pos];
+    }
+
+    bool operator==(const Iterator& rhs) const noexcept
+    {
+      return mIndex == rhs.mIndex;
+    }
+
+    bool operator!=(const Iterator& rhs) const noexcept
+    {
+      return !operator==(rhs);
+    }
+
+    bool operator<(const Iterator& rhs) const noexcept
+    {
+      return mIndex < rhs.mIndex;
+    }
+
+    bool operator>(const Iterator& rhs) const noexcept
+    {
+      return rhs < *this;
+    }
+
+    bool operator<=(const Iterator& rhs) const noexcept
+    {
+      return !(rhs < *this);
+    }
+
+    bool operator>=(const Iterator& rhs) const noexcept
+    {
+      return !(*this < rhs);
+    }
+
+    Iterator& operator++() noexcept
+    {
+      ++mIndex;
+      return *this;
+    }
+
+    Iterator operator++(int) noexcept
+    {
+      Iterator tmp{ *this };
+      ++mIndex;
+      return tmp;
+    }
+
+    Iterator& operator--() noexcept
+    {
+      --mIndex;
+      return *this;
+    }
+
+    Iterator operator--(int) noexcept
+    {
+      Iterator tmp{ *this };
+      --mIndex;
+      return tmp;
+    }
+
+    Iterator& operator+=(difference_type pos) noexcept
+    {
+      mIndex += pos;
+      return *this;
+    }
+
+    Iterator& operator-=(difference_type pos) noexcept
+    {
+      mIndex -= pos;
+      return *this;
+    }
+
+    Iterator operator+(difference_type pos) const noexcept
+    {
+      return { mBuffer, mIndex + pos };
+    }
+
+    friend Iterator operator+(difference_type pos, const Iterator& iter) noexcept
+    {
+      return iter + pos;
+    }
+
+    Iterator operator-(difference_type pos) const noexcept
+    {
+      return { mBuffer, mIndex - pos };
+    }
+
+    difference_type operator-(const Iterator& rhs) const noexcept
+    {
+      return static_cast<difference_type>(mIndex - rhs.mIndex);
+    }
+  };
+
+  StaticCircularBuffer() noexcept
+    : mStart{ 0 }, mSize{ 0 }
+  { }
+
+  StaticCircularBuffer(const StaticCircularBuffer& rhs)
+    : mStart{ 0 }, mSize{ 0 }
+  {
+    for (size_t i = 0; i != rhs.mSize; ++i)
+      emplace(rhs[i]);
+  }
+
+  StaticCircularBuffer(StaticCircularBuffer&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>)
+    : mStart{ 0 }, mSize{ 0 }
+  {
+    for (size_t i = 0; i != rhs.mSize; ++i)
+      emplace(std::move(rhs[i]));
+    rhs.clear();
+  }
+
+  StaticCircularBuffer(std::initializer_list<T> il)
+    : mStart{ 0 }, mSize{ 0 }
+  {
+    for (const auto& value : il)
+      emplace(value);
+  }
+
+  StaticCircularBuffer& operator=(const StaticCircularBuffer& rhs)
+  {
+    if (this == &rhs)
+      return *this;
+    clear();
+    for (size_t i = 0; i != rhs.mSize; ++i)
+      emplace(rhs[i]);
+    return *this;
+  }
+
+  StaticCircularBuffer& operator=(StaticCircularBuffer&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>)
+  {
+    if (this == &rhs)
+      return *this;
+    clear();
+    for (size_t i = 0; i != rhs.mSize; ++i)
+      emplace(std::move(rhs[i]));
+    rhs.clear();
+    return *this;
+  }
+
+  ~StaticCircularBuffer()
+  {
+    clear();
+  }
+
+  void clear() noexcept
+  {
+    if constexpr (!std::is_trivially_destructible_v<T>)
+    {
+      for (size_t i = 0; i != mSize; ++i)
+        slot(Wrap(mStart + i))->~T();
+    }
+    mStart = 0;
+    mSize = 0;
+  }
+
+  size_t size() const noexcept
+  {
+    return mSize;
+  }
+
+  bool empty() const noexcept
+  {
+    return mSize == 0;
+  }
+
+  bool full() const noexcept
+  {
+    return mSize == N;
+  }
+
+  static constexpr size_t capacity() noexcept
+  {
+    return N;
+  }
+
+  const T& operator[](size_t index) const noexcept
+  {
+    return *slot(Wrap(mStart + index));
+  }
+
+  T& operator[](size_t index) noexcept
+  {
+    return *slot(Wrap(mStart + index));
+  }
+
+  const T& at(size_t index) const
+  {
+    if (index >= mSize)
+      throw std::out_of_range{ "array out of bounds!" };
+    return operator[](index);
+  }
+
+  T& at(size_t index)
+  {
+    if (index >= mSize)
+      throw std::out_of_range{ "array out of bounds!" };
+    return operator[](index);
+  }
+
+  void push(const T& value)
+  {
+    emplace(value);
+  }
+
+  void push(T&& value)
+  {
+    emplace(std::move(value));
+  }
+
+  template <typename ... Args>
+  void emplace(Args&& ... args)
+  {
+    if (mSize != N)
+    {
+      new (slot(Wrap(mStart + mSize))) T{ std::forward<Args>(args)... };
+      ++mSize;
+      return;
+    }
+
+    // full: the oldest slot becomes the newest
+    T* oldest = slot(mStart);
+    oldest->~T();
+    try
+    {
+      new (oldest) T{ std::forward<Args>(args)... };
+    }
+    catch (...)
+    {
+      // the oldest element is already gone, so drop its slot instead of leaving it dangling
+      mStart = Wrap(mStart + 1);
+      --mSize;
+      throw;
+    }
+    mStart = Wrap(mStart + 1);
+  }
+
+  // removes the newest element
+  void pop() noexcept
+  {
+    --mSize;
+    slot(Wrap(mStart + mSize))->~T();
+  }
+
+  // removes the oldest element
+  void pop_front() noexcept
+  {
+    slot(mStart)->~T();
+    mStart = Wrap(mStart + 1);
+    --mSize;
+  }
+
+  const T& back() const noexcept
+  {
+    return operator[](mSize - 1);
+  }
+
+  T& back() noexcept
+  {
+    return operator[](mSize - 1);
+  }
+
+  const T& front() const noexcept
+  {
+    return *slot(mStart);
+  }
+
+  T& front() noexcept
+  {
+    return *slot(mStart);
+  }
+
+  Iterator<StaticCircularBuffer, T> begin() noexcept
+  {
+    return { this, 0 };
+  }
+
+  Iterator<StaticCircularBuffer, T> end() noexcept
+  {
+    return { this, mSize };
+  }
+
+  Iterator<const StaticCircularBuffer, const T> begin() const noexcept
+  {
+    return { this, 0 };
+  }
+
+  Iterator<const StaticCircularBuffer, const T> end() const noexcept
+  {
+    return { this, mSize };
+  }
+
+  Iterator<const StaticCircularBuffer, const T> cbegin() const noexcept
+  {
+    return { this, 0 };
+  }
+
+  Iterator<const StaticCircularBuffer, const T> cend() const noexcept
+  {
+    return { this, mSize };
+  }
+
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = Iterator<StaticCircularBuffer, T>;
+  using const_iterator = Iterator<const StaticCircularBuffer, const T>;
+};
+
+}
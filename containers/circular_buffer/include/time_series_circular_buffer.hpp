@@ -0,0 +1,210 @@
+#pragma once
+
+#include <containers/circular_buffer/include/circular_buffer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace regit::containers {
+
+// CircularBuffer of timestamped samples bounded by capacity and, optionally, by age.
+// Timestamps live in their own ring next to the payloads, so scans over the values stay
+// dense, and since they only ever grow, time windows are found with a binary search.
+// A push first evicts every sample older than max_age() relative to the new timestamp.
+template <typename T, typename ClockT = std::chrono::steady_clock, typename Allocator = std::allocator<T>>
+class TimeSeriesCircularBuffer
+{
+public:
+  using time_point = typename ClockT::time_point;
+  using duration = typename ClockT::duration;
+
+private:
+  using time_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<time_point>;
+
+  CircularBuffer<T, Allocator> mValues;
+  CircularBuffer<time_point, time_allocator_t> mTimes;
+  duration mMaxAge;
+
+  // index of the first sample stamped at or after t
+  size_t LowerBound(time_point t) const noexcept
+  {
+    return static_cast<size_t>(std::lower_bound(mTimes.cbegin(), mTimes.cend(), t) - mTimes.cbegin());
+  }
+
+  // index of the first sample stamped after t
+  size_t UpperBound(time_point t) const noexcept
+  {
+    return static_cast<size_t>(std::upper_bound(mTimes.cbegin(), mTimes.cend(), t) - mTimes.cbegin());
+  }
+
+  template <typename ... Args>
+  void EmplaceAt(time_point t, Args&& ... args)
+  {
+    if (!mTimes.empty() && t < mTimes.back())
+      throw std::invalid_argument{ "timestamps must not go backwards!" };
+
+    evict(t);
+    mValues.emplace(std::forward<Args>(args)...);
+    mTimes.push(t);
+  }
+
+public:
+  // maxAge of duration::max() only evicts by capacity
+  explicit TimeSeriesCircularBuffer(size_t size, duration maxAge = duration::max(), const Allocator& alloc = Allocator())
+    : mValues(size, alloc), mTimes(size, time_allocator_t(alloc)), mMaxAge{ maxAge }
+  { }
+
+  void push(const T& value)
+  {
+    EmplaceAt(ClockT::now(), value);
+  }
+
+  // t must not be earlier than the newest timestamp
+  void push(const T& value, time_point t)
+  {
+    EmplaceAt(t, value);
+  }
+
+  template <typename ... Args>
+  void emplace_at(time_point t, Args&& ... args)
+  {
+    EmplaceAt(t, std::forward<Args>(args)...);
+  }
+
+  // drops every sample older than max_age() relative to now, returns how many were dropped
+  size_t evict(time_point now)
+  {
+    if (mMaxAge == duration::max() || mTimes.empty() || now - mTimes.front() <= mMaxAge)
+      return 0;
+
+    size_t expired = LowerBound(now - mMaxAge);
+    for (size_t i = 0; i != expired; ++i)
+    {
+      mValues.pop_front();
+      mTimes.pop_front();
+    }
+    return expired;
+  }
+
+  // values stamped within [t0, t1], as at most two contiguous runs
+  std::pair<Span<const T>, Span<const T>> range(time_point t0, time_point t1) const noexcept
+  {
+    auto [first, last] = bounds(t0, t1);
+    return segments(mValues.cbegin() + first, mValues.cbegin() + last);
+  }
+
+  // timestamps of the values returned by range(t0, t1)
+  std::pair<Span<const time_point>, Span<const time_point>> time_range(time_point t0, time_point t1) const noexcept
+  {
+    auto [first, last] = bounds(t0, t1);
+    return segments(mTimes.cbegin() + first, mTimes.cbegin() + last);
+  }
+
+  // [first, last) indices of the values stamped within [t0, t1]
+  std::pair<size_t, size_t> bounds(time_point t0, time_point t1) const noexcept
+  {
+    if (t1 < t0)
+      return { 0, 0 };
+    size_t first = LowerBound(t0);
+    return { first, std::max(first, UpperBound(t1)) };
+  }
+
+  // values of the newest window of time, i.e. stamped within [back_time() - window, back_time()]
+  std::pair<Span<const T>, Span<const T>> last(duration window) const noexcept
+  {
+    if (empty())
+      return { };
+    return range(mTimes.back() - window, mTimes.back());
+  }
+
+  size_t count(time_point t0, time_point t1) const noexcept
+  {
+    auto [first, last] = bounds(t0, t1);
+    return last - first;
+  }
+
+  void clear()
+  {
+    mValues.clear();
+    mTimes.clear();
+  }
+
+  size_t size() const noexcept
+  {
+    return mValues.size();
+  }
+
+  bool empty() const noexcept
+  {
+    return mValues.empty();
+  }
+
+  size_t capacity() const noexcept
+  {
+    return mValues.capacity();
+  }
+
+  duration max_age() const noexcept
+  {
+    return mMaxAge;
+  }
+
+  const T& operator[](size_t index) const noexcept
+  {
+    return *(mValues.cbegin() + index);
+  }
+
+  const T& at(size_t index) const
+  {
+    if (index >= size())
+      throw std::out_of_range{ "array out of bounds!" };
+    return operator[](index);
+  }
+
+  time_point time_at(size_t index) const
+  {
+    if (index >= size())
+      throw std::out_of_range{ "array out of bounds!" };
+    return *(mTimes.cbegin() + index);
+  }
+
+  const T& front() const noexcept
+  {
+    return *mValues.cbegin();
+  }
+
+  const T& back() const noexcept
+  {
+    return *(mValues.cend() - 1);
+  }
+
+  time_point front_time() const noexcept
+  {
+    return *mTimes.cbegin();
+  }
+
+  time_point back_time() const noexcept
+  {
+    return *(mTimes.cend() - 1);
+  }
+
+  const CircularBuffer<T, Allocator>& values() const noexcept
+  {
+    return mValues;
+  }
+
+  const CircularBuffer<time_point, time_allocator_t>& timestamps() const noexcept
+  {
+    return mTimes;
+  }
+
+  using value_type = T;
+  using size_type = size_t;
+  using const_reference = const T&;
+};
+
+}
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <containers/circular_buffer/include/circular_buffer.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace regit::containers {
+
+namespace detail
+{
+  inline double SumOf(const double* values, size_t count) noexcept
+  {
+    size_t i = 0;
+    double sum = 0.0;
+#if defined(__AVX__)
+    __m256d acc = _mm256_setzero_pd();
+    for (; i + 4 <= count; i += 4)
+      acc = _mm256_add_pd(acc, _mm256_loadu_pd(values + i));
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(__SSE2__)
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    for (; i + 4 <= count; i += 4)
+    {
+      acc0 = _mm_add_pd(acc0, _mm_loadu_pd(values + i));
+      acc1 = _mm_add_pd(acc1, _mm_loadu_pd(values + i + 2));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(acc0, acc1));
+    sum = lanes[0] + lanes[1];
+#endif
+    for (; i != count; ++i)
+      sum += values[i];
+    return sum;
+  }
+
+  inline double SquaredDeviationsOf(const double* values, size_t count, double mean) noexcept
+  {
+    size_t i = 0;
+    double sum = 0.0;
+#if defined(__AVX__)
+    const __m256d center = _mm256_set1_pd(mean);
+    __m256d acc = _mm256_setzero_pd();
+    for (; i + 4 <= count; i += 4)
+    {
+      __m256d delta = _mm256_sub_pd(_mm256_loadu_pd(values + i), center);
+      acc = _mm256_add_pd(acc, _mm256_mul_pd(delta, delta));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(__SSE2__)
+    const __m128d center = _mm_set1_pd(mean);
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    for (; i + 4 <= count; i += 4)
+    {
+      __m128d delta0 = _mm_sub_pd(_mm_loadu_pd(values + i), center);
+      __m128d delta1 = _mm_sub_pd(_mm_loadu_pd(values + i + 2), center);
+      acc0 = _mm_add_pd(acc0, _mm_mul_pd(delta0, delta0));
+      acc1 = _mm_add_pd(acc1, _mm_mul_pd(delta1, delta1));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(acc0, acc1));
+    sum = lanes[0] + lanes[1];
+#endif
+    for (; i != count; ++i)
+      sum += (values[i] - mean) * (values[i] - mean);
+    return sum;
+  }
+
+  // generic fallbacks, simple enough for the compiler to vectorise on its own
+  template <typename T>
+  double SumOf(const T* values, size_t count) noexcept
+  {
+    double sum = 0.0;
+    for (size_t i = 0; i != count; ++i)
+      sum += static_cast<double>(values[i]);
+    return sum;
+  }
+
+  template <typename T>
+  double SquaredDeviationsOf(const T* values, size_t count, double mean) noexcept
+  {
+    double sum = 0.0;
+    for (size_t i = 0; i != count; ++i)
+    {
+      double delta = static_cast<double>(values[i]) - mean;
+      sum += delta * delta;
+    }
+    return sum;
+  }
+
+} // detail namespace
+
+// Rolling window over the last capacity() samples with O(1) amortised statistics.
+// Mean and variance follow Welford's update (extended to replace the evicted sample) and
+// min/max come from monotonic queues of (value, sequence) pairs. The running accumulators
+// can drift after very long runs; recompute() re-anchors them from the window contents
+// with a vectorised two-pass scan, and push_range() does so automatically.
+template <typename T>
+class WindowedStatistics
+{
+  static_assert(std::is_arithmetic_v<T>, "WindowedStatistics requires an arithmetic type");
+
+  struct Extremum
+  {
+    T Value;
+    uint64_t Sequence;
+  };
+
+  CircularBuffer<T> mWindow;
+  CircularBuffer<Extremum> mMin, mMax;
+  uint64_t mPushed;
+  double mMean;
+  double mM2;
+
+  template <typename CompareT>
+  static void PushExtremum(CircularBuffer<Extremum>& queue, T value, uint64_t sequence, CompareT dominates)
+  {
+    // anything the new value dominates can never become the extremum again
+    while (!queue.empty() && !dominates(queue.back().Value, value))
+      queue.pop();
+    queue.emplace(Extremum{ value, sequence });
+  }
+
+  static void EvictExtremum(CircularBuffer<Extremum>& queue, uint64_t sequence)
+  {
+    if (!queue.empty() && queue.front().Sequence == sequence)
+      queue.pop_front();
+  }
+
+  void RebuildExtrema()
+  {
+    mMin.clear();
+    mMax.clear();
+    uint64_t sequence = mPushed - mWindow.size();
+    for (const T& value : mWindow)
+    {
+      PushExtremum(mMin, value, sequence, std::less<T>{});
+      PushExtremum(mMax, value, sequence, std::greater<T>{});
+      ++sequence;
+    }
+  }
+
+public:
+  explicit WindowedStatistics(size_t window)
+    : mWindow(window), mMin(window), mMax(window), mPushed{ 0 }, mMean{ 0.0 }, mM2{ 0.0 }
+  { }
+
+  void push(T value)
+  {
+    const double x = static_cast<double>(value);
+    if (mWindow.size() == mWindow.capacity())
+    {
+      const T evicted = mWindow.front();
+      const double old = static_cast<double>(evicted);
+      EvictExtremum(mMin, mPushed - mWindow.capacity());
+      EvictExtremum(mMax, mPushed - mWindow.capacity());
+
+      // replace old with x in place, the count stays the same
+      const double oldMean = mMean;
+      mMean += (x - old) / static_cast<double>(mWindow.size());
+      mM2 += (x - old) * (x - mMean + old - oldMean);
+      if (mM2 < 0.0)
+        mM2 = 0.0;
+    }
+    else
+    {
+      const double delta = x - mMean;
+      mMean += delta / static_cast<double>(mWindow.size() + 1);
+      mM2 += delta * (x - mMean);
+    }
+
+    mWindow.push(value);
+    PushExtremum(mMin, value, mPushed, std::less<T>{});
+    PushExtremum(mMax, value, mPushed, std::greater<T>{});
+    ++mPushed;
+  }
+
+  void emplace(T value)
+  {
+    push(value);
+  }
+
+  // bulk load, then re-anchor everything from the window contents. Single pass iterators
+  // are counted while they are consumed, forward iterators are measured up front
+  template <typename InputIt>
+  void push_range(InputIt first, InputIt last)
+  {
+    // every value pushed counts towards the sequence, including ones that fall out again
+    using category_t = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (!std::is_base_of_v<std::forward_iterator_tag, category_t>)
+    {
+      for (; first != last; ++first, ++mPushed)
+        mWindow.push(*first);
+    }
+    else
+    {
+      mPushed += static_cast<uint64_t>(std::distance(first, last));
+      mWindow.push_range(first, last);
+    }
+    recompute();
+  }
+
+  // recomputes mean, variance and the extrema from scratch in O(window)
+  void recompute()
+  {
+    const size_t count = mWindow.size();
+    if (!count)
+    {
+      mMean = mM2 = 0.0;
+      RebuildExtrema();
+      return;
+    }
+
+    auto one = mWindow.array_one();
+    auto two = mWindow.array_two();
+    mMean = (detail::SumOf(one.data(), one.size()) + detail::SumOf(two.data(), two.size()))
+      / static_cast<double>(count);
+    mM2 = detail::SquaredDeviationsOf(one.data(), one.size(), mMean)
+      + detail::SquaredDeviationsOf(two.data(), two.size(), mMean);
+    RebuildExtrema();
+  }
+
+  void clear()
+  {
+    mWindow.clear();
+    mMin.clear();
+    mMax.clear();
+    mMean = mM2 = 0.0;
+  }
+
+  size_t size() const noexcept
+  {
+    return mWindow.size();
+  }
+
+  bool empty() const noexcept
+  {
+    return mWindow.empty();
+  }
+
+  size_t capacity() const noexcept
+  {
+    return mWindow.capacity();
+  }
+
+  double sum() const noexcept
+  {
+    return mMean * static_cast<double>(mWindow.size());
+  }
+
+  double mean() const noexcept
+  {
+    return mMean;
+  }
+
+  // population variance of the window
+  double variance() const noexcept
+  {
+    return mWindow.empty() ? 0.0 : mM2 / static_cast<double>(mWindow.size());
+  }
+
+  double sample_variance() const noexcept
+  {
+    return mWindow.size() < 2 ? 0.0 : mM2 / static_cast<double>(mWindow.size() - 1);
+  }
+
+  double stddev() const noexcept
+  {
+    return std::sqrt(variance());
+  }
+
+  // min/max/front/back must only be called on a non-empty window
+  T min() const noexcept
+  {
+    return mMin.front().Value;
+  }
+
+  T max() const noexcept
+  {
+    return mMax.front().Value;
+  }
+
+  const CircularBuffer<T>& window() const noexcept
+  {
+    return mWindow;
+  }
+};
+
+}
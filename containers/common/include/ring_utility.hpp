@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <thread>
+
+namespace regit::containers {
+
+// helpers shared by the lock-free rings and queues
+namespace detail
+{
+  // rings index with a mask, so their capacity is rounded up to a power of two
+  inline size_t RoundUpPowerOfTwo(size_t value) noexcept
+  {
+    size_t result = 1;
+    while (result < value)
+      result <<= 1;
+    return result;
+  }
+
+  // spin for spinLimit attempts, then give the time slice away while the other side catches up
+  inline void Backoff(unsigned& attempt, unsigned spinLimit) noexcept
+  {
+    if (attempt < spinLimit)
+      ++attempt;
+    else
+      std::this_thread::yield();
+  }
+
+} // detail namespace
+
+}
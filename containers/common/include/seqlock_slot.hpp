@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace regit::containers {
+
+namespace detail
+{
+  // Slot of a single-writer overwrite ring. The writer never waits for readers: it marks
+  // the slot as being written, copies the payload and stamps it with the new sequence, and
+  // a reader copies the payload optimistically and keeps the copy only if the stamp did not
+  // change meanwhile. Plain data, so it can live in memory shared between processes.
+  template <typename T>
+  struct SeqlockSlot
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqlockSlot requires a trivially copyable T");
+
+    // sequence + 1 of the element stored in the slot, 0 while it is being written
+    std::atomic<uint64_t> Sequence;
+    T Payload;
+
+    // writer only
+    void Write(uint64_t sequence, const T& value) noexcept
+    {
+      Sequence.store(0, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      memcpy(&Payload, &value, sizeof(T));
+      Sequence.store(sequence + 1, std::memory_order_release);
+    }
+
+    // false if the slot holds another element or was rewritten while it was copied
+    bool TryRead(uint64_t sequence, T& value) const noexcept
+    {
+      if (Sequence.load(std::memory_order_acquire) != sequence + 1)
+        return false;
+      memcpy(&value, &Payload, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return Sequence.load(std::memory_order_relaxed) == sequence + 1;
+    }
+  };
+
+} // detail namespace
+
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cerrno>
+#include <system_error>
+
+namespace regit::containers {
+
+namespace detail
+{
+  // reports a failed system call with the errno it left behind
+  [[noreturn]] inline void ThrowSystemError(const char* what)
+  {
+    throw std::system_error{ errno, std::generic_category(), what };
+  }
+
+} // detail namespace
+
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <containers/common/include/ring_utility.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace regit::containers {
+
+// Bounded multi-producer/multi-consumer queue.
+// Every slot carries a sequence number that tells producers and consumers whose turn it is,
+// so a producer only contends on the tail counter and a consumer only on the head counter.
+// The capacity is rounded up to the next power of two.
+template <typename T, typename Allocator = std::allocator<T>>
+class MpmcQueue
+{
+  static constexpr size_t CACHE_LINE = 64;
+  static constexpr unsigned SPIN_LIMIT = 64;
+
+  struct Slot
+  {
+    std::atomic<size_t> mSequence;
+    alignas(T) unsigned char mStorage[sizeof(T)];
+
+    T* get() noexcept
+    {
+      return std::launder(reinterpret_cast<T*>(mStorage));
+    }
+  };
+
+  using slot_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+
+  slot_allocator_t mAlloc;
+  size_t mCap;
+  size_t mMask;
+  Slot* mSlots;
+
+  alignas(CACHE_LINE) std::atomic<size_t> mTail;
+  alignas(CACHE_LINE) std::atomic<size_t> mHead;
+
+public:
+  explicit MpmcQueue(size_t size = 1)
+    : mAlloc{ }, mCap{ detail::RoundUpPowerOfTwo(size) }, mMask{ mCap - 1 },
+      mSlots{ mAlloc.allocate(mCap) }, mTail{ 0 }, mHead{ 0 }
+  {
+    for (size_t i = 0; i != mCap; ++i)
+      new (&mSlots[i].mSequence) std::atomic<size_t>{ i };
+  }
+
+  MpmcQueue(const MpmcQueue&) = delete;
+  MpmcQueue(MpmcQueue&&) = delete;
+  MpmcQueue& operator=(const MpmcQueue&) = delete;
+  MpmcQueue& operator=(MpmcQueue&&) = delete;
+
+  ~MpmcQueue()
+  {
+    if constexpr (!std::is_trivially_destructible_v<T>)
+    {
+      size_t tail = mTail.load(std::memory_order_relaxed);
+      for (size_t head = mHead.load(std::memory_order_relaxed); head != tail; ++head)
+        mSlots[head & mMask].get()->~T();
+    }
+    mAlloc.deallocate(mSlots, mCap);
+    mSlots = nullptr;
+  }
+
+  template <typename ... Args>
+  bool try_emplace(Args&& ... args)
+  {
+    size_t pos = mTail.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;)
+    {
+      slot = mSlots + (pos & mMask);
+      size_t seq = slot->mSequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+      if (diff == 0)
+      {
+        if (mTail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+        return false;
+      else
+        pos = mTail.load(std::memory_order_relaxed);
+    }
+
+    new (slot->mStorage) T{ std::forward<Args>(args)... };
+    slot->mSequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_push(const T& value)
+  {
+    return try_emplace(value);
+  }
+
+  bool try_push(T&& value)
+  {
+    return try_emplace(std::move(value));
+  }
+
+  bool try_pop(T& value)
+  {
+    size_t pos = mHead.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;)
+    {
+      slot = mSlots + (pos & mMask);
+      size_t seq = slot->mSequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+      if (diff == 0)
+      {
+        if (mHead.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+        return false;
+      else
+        pos = mHead.load(std::memory_order_relaxed);
+    }
+
+    T* element = slot->get();
+    value = std::move(*element);
+    element->~T();
+    // hand the slot to the producer one lap ahead
+    slot->mSequence.store(pos + mCap, std::memory_order_release);
+    return true;
+  }
+
+  template <typename ... Args>
+  void emplace(Args&& ... args)
+  {
+    unsigned attempt = 0;
+    while (!try_emplace(std::forward<Args>(args)...))
+      detail::Backoff(attempt, SPIN_LIMIT);
+  }
+
+  void push(const T& value)
+  {
+    emplace(value);
+  }
+
+  void push(T&& value)
+  {
+    // try_emplace only consumes its arguments once it succeeds
+    emplace(std::move(value));
+  }
+
+  void pop(T& value)
+  {
+    unsigned attempt = 0;
+    while (!try_pop(value))
+      detail::Backoff(attempt, SPIN_LIMIT);
+  }
+
+  // approximate when called while other threads are active
+  size_t size() const noexcept
+  {
+    const size_t head = mHead.load(std::memory_order_acquire);
+    const size_t tail = mTail.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  size_t capacity() const noexcept
+  {
+    return mCap;
+  }
+
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  using reference = T&;
+  using const_reference = const T&;
+};
+
+}
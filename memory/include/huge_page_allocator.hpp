@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <system_error>
+#include <type_traits>
+
+#if !defined(__linux__)
+#error "HugePageAllocator relies on mmap/mbind and is only available on Linux"
+#endif
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+
+namespace regit::memory {
+
+namespace detail
+{
+  constexpr size_t HUGE_PAGE_SIZE = size_t{ 2 } << 20;
+
+  inline size_t RoundUpToHugePage(size_t bytes) noexcept
+  {
+    return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+  }
+
+  // prefers pages from the reserved hugetlbfs pool and falls back to transparent huge pages
+  inline void* MapHugePages(size_t bytes) noexcept
+  {
+    void* address = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+    if (address != MAP_FAILED)
+      return address;
+
+    // transparent huge pages need a 2 MB aligned range, over-map and trim both ends
+    address = mmap(nullptr, bytes + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (address == MAP_FAILED)
+      return nullptr;
+    auto start = reinterpret_cast<uintptr_t>(address);
+    uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    if (aligned != start)
+      munmap(address, aligned - start);
+    munmap(reinterpret_cast<void*>(aligned + bytes), start + HUGE_PAGE_SIZE - aligned);
+
+    // best effort, THP may be disabled system wide
+    madvise(reinterpret_cast<void*>(aligned), bytes, MADV_HUGEPAGE);
+    return reinterpret_cast<void*>(aligned);
+  }
+
+  // binds the not yet touched range to node, so the first touch already faults in local pages
+  inline int BindToNode(void* address, size_t bytes, int node) noexcept
+  {
+    constexpr size_t BITS = sizeof(unsigned long) * 8;
+    unsigned long mask[16] = { };
+    if (node < 0 || static_cast<size_t>(node) >= BITS * 16)
+      return EINVAL;
+    mask[static_cast<size_t>(node) / BITS] = 1ul << (static_cast<size_t>(node) % BITS);
+
+    if (syscall(SYS_mbind, address, bytes, MPOL_BIND, mask, BITS * 16, MPOL_MF_STRICT) == -1)
+      // a kernel without NUMA support has only one node anyway
+      return errno == ENOSYS ? 0 : errno;
+    return 0;
+  }
+
+} // detail namespace
+
+// Allocator for large, long-lived buffers such as multi-megabyte CircularBuffer rings.
+// Requests of at least threshold() bytes are mapped directly and rounded up to whole 2 MB
+// pages: explicit huge pages (MAP_HUGETLB) when the system has some reserved, transparent huge
+// pages (madvise) otherwise. With a node() of 0 or more the mapping is bound to that NUMA
+// node before it is touched. Smaller requests go through the regular heap.
+template <typename T>
+class HugePageAllocator
+{
+  static constexpr int ANY_NODE = -1;
+
+  int mNode;
+  size_t mThreshold;
+
+  template <typename U>
+  friend class HugePageAllocator;
+
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
+
+  explicit HugePageAllocator(int node = ANY_NODE, size_t threshold = detail::HUGE_PAGE_SIZE) noexcept
+    : mNode{ node }, mThreshold{ threshold }
+  { }
+
+  template <typename U>
+  HugePageAllocator(const HugePageAllocator<U>& rhs) noexcept
+    : mNode{ rhs.mNode }, mThreshold{ rhs.mThreshold }
+  { }
+
+  T* allocate(size_t count)
+  {
+    if (count > SIZE_MAX / sizeof(T))
+      throw std::bad_array_new_length{ };
+
+    const size_t bytes = sizeof(T) * count;
+    if (bytes < mThreshold || !bytes)
+      return std::allocator<T>{ }.allocate(count);
+
+    const size_t mapped = detail::RoundUpToHugePage(bytes);
+    void* address = detail::MapHugePages(mapped);
+    if (!address)
+      throw std::bad_alloc{ };
+
+    if (mNode != ANY_NODE)
+    {
+      int error = detail::BindToNode(address, mapped, mNode);
+      if (error)
+      {
+        munmap(address, mapped);
+        throw std::system_error{ error, std::generic_category(), "mbind failed" };
+      }
+    }
+    return static_cast<T*>(address);
+  }
+
+  void deallocate(T* pointer, size_t count) noexcept
+  {
+    const size_t bytes = sizeof(T) * count;
+    if (bytes < mThreshold || !bytes)
+      std::allocator<T>{ }.deallocate(pointer, count);
+    else
+      munmap(pointer, detail::RoundUpToHugePage(bytes));
+  }
+
+  // resizes a mapped allocation with mremap, which may move it but never copies the pages;
+  // returns nullptr and leaves the allocation alone if either size is served from the heap
+  T* reallocate(T* pointer, size_t count, size_t newCount) noexcept
+  {
+    if (newCount > SIZE_MAX / sizeof(T))
+      return nullptr;
+
+    const size_t bytes = sizeof(T) * count;
+    const size_t newBytes = sizeof(T) * newCount;
+    if (bytes < mThreshold || !bytes || newBytes < mThreshold || !newBytes)
+      return nullptr;
+
+    // the NUMA policy belongs to the mapping and comes along
+    void* address = mremap(pointer, detail::RoundUpToHugePage(bytes), detail::RoundUpToHugePage(newBytes), MREMAP_MAYMOVE);
+    return address == MAP_FAILED ? nullptr : static_cast<T*>(address);
+  }
+
+  // NUMA node the mappings are bound to, -1 if they are not bound
+  int node() const noexcept
+  {
+    return mNode;
+  }
+
+  // smallest request in bytes that is mapped instead of taken from the heap
+  size_t threshold() const noexcept
+  {
+    return mThreshold;
+  }
+
+  // memory from one allocator can be freed by the other, the node only matters for allocate
+  template <typename U>
+  bool operator==(const HugePageAllocator<U>& rhs) const noexcept
+  {
+    return mThreshold == rhs.mThreshold;
+  }
+
+  template <typename U>
+  bool operator!=(const HugePageAllocator<U>& rhs) const noexcept
+  {
+    return !operator==(rhs);
+  }
+};
+
+}
@@ -0,0 +1,325 @@
+#include <containers/circular_buffer/include/circular_buffer.hpp>
+#include <simple_benchmark.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  volatile size_t Sink;
+
+  // std::deque used as a bounded ring: drop the front once it is full
+  template <typename T>
+  class DequeRing
+  {
+    std::deque<T> mItems;
+    size_t mCap;
+
+  public:
+    using value_type = T;
+
+    explicit DequeRing(size_t size)
+      : mItems(), mCap{ size }
+    { }
+
+    void push(const T& value)
+    {
+      if (mItems.size() == mCap)
+        mItems.pop_front();
+      mItems.push_back(value);
+    }
+
+    template <typename ... Args>
+    void emplace(Args&& ... args)
+    {
+      if (mItems.size() == mCap)
+        mItems.pop_front();
+      mItems.emplace_back(std::forward<Args>(args)...);
+    }
+
+    void pop_front()
+    {
+      mItems.pop_front();
+    }
+
+    const T& operator[](size_t index) const
+    {
+      return mItems[index];
+    }
+
+    template <typename FunctorT>
+    void visit(FunctorT&& f) const
+    {
+      for (const T& value : mItems)
+        f(value);
+    }
+
+    void clear()
+    {
+      mItems.clear();
+    }
+
+    size_t size() const noexcept
+    {
+      return mItems.size();
+    }
+  };
+
+  // the hand-rolled ring most code bases start with: a std::vector plus head and size
+  template <typename T>
+  class VectorRing
+  {
+    std::vector<T> mItems;
+    size_t mHead;
+    size_t mSize;
+
+    size_t Wrap(size_t position) const noexcept
+    {
+      return position >= mItems.size() ? position - mItems.size() : position;
+    }
+
+  public:
+    using value_type = T;
+
+    explicit VectorRing(size_t size)
+      : mItems(size), mHead{ 0 }, mSize{ 0 }
+    { }
+
+    void push(const T& value)
+    {
+      mItems[Wrap(mHead + mSize)] = value;
+      if (mSize == mItems.size())
+        mHead = Wrap(mHead + 1);
+      else
+        ++mSize;
+    }
+
+    template <typename ... Args>
+    void emplace(Args&& ... args)
+    {
+      mItems[Wrap(mHead + mSize)] = T(std::forward<Args>(args)...);
+      if (mSize == mItems.size())
+        mHead = Wrap(mHead + 1);
+      else
+        ++mSize;
+    }
+
+    void pop_front()
+    {
+      mItems[mHead] = T{ };
+      mHead = Wrap(mHead + 1);
+      --mSize;
+    }
+
+    const T& operator[](size_t index) const
+    {
+      return mItems[Wrap(mHead + index)];
+    }
+
+    template <typename FunctorT>
+    void visit(FunctorT&& f) const
+    {
+      for (size_t i = 0; i != mSize; ++i)
+        f(mItems[Wrap(mHead + i)]);
+    }
+
+    void clear()
+    {
+      std::fill(mItems.begin(), mItems.end(), T{ });
+      mHead = 0;
+      mSize = 0;
+    }
+
+    void resize(size_t size)
+    {
+      const size_t kept = std::min(mSize, size);
+      std::vector<T> items(size);
+      for (size_t i = 0; i != kept; ++i)
+        items[i] = std::move(mItems[Wrap(mHead + mSize - kept + i)]);
+      mItems.swap(items);
+      mHead = 0;
+      mSize = kept;
+    }
+
+    size_t size() const noexcept
+    {
+      return mSize;
+    }
+  };
+
+  template <typename T>
+  class CircularRing : public regit::containers::CircularBuffer<T>
+  {
+  public:
+    using regit::containers::CircularBuffer<T>::CircularBuffer;
+
+    template <typename FunctorT>
+    void visit(FunctorT&& f) const
+    {
+      for (const T& value : *this)
+        f(value);
+    }
+  };
+
+  template <typename T>
+  struct Values;
+
+  template <>
+  struct Values<uint64_t>
+  {
+    static constexpr const char* NAME = "u64";
+
+    static uint64_t Make(size_t i)
+    {
+      return i;
+    }
+
+    static size_t Weigh(uint64_t value)
+    {
+      return value;
+    }
+  };
+
+  // long enough to live on the heap, so every copy allocates
+  template <>
+  struct Values<std::string>
+  {
+    static constexpr const char* NAME = "string";
+
+    static std::string Make(size_t i)
+    {
+      return "instrument-" + std::to_string(i) + "-xxxxxxxxxxxxxxxx";
+    }
+
+    static size_t Weigh(const std::string& value)
+    {
+      return value.size();
+    }
+  };
+
+  using clock_t = std::chrono::steady_clock;
+
+  template <typename RingT>
+  void Fill(RingT& ring, const std::vector<typename RingT::value_type>& values, size_t count)
+  {
+    for (size_t i = 0; i != count; ++i)
+      ring.push(values[i % values.size()]);
+  }
+
+  // every operation runs over at least a few capacities worth of elements
+  template <template <typename> class RingT, typename T>
+  void Run(const char* container, size_t capacity, const std::string& testCase, bool resizable)
+  {
+    using ring_t = RingT<T>;
+    using values_t = Values<T>;
+    auto& bench = regit::benchmarking::TheBenchmark;
+    const size_t operations = std::max(bench.scale(50'000'000 / (sizeof(T) / 8)), capacity * 2);
+    const size_t rounds = std::max<size_t>(operations / capacity, 1);
+    auto name = [container](const char* operation) { return std::string{ container } + "::" + operation; };
+
+    std::vector<T> values;
+    values.reserve(1024);
+    for (size_t i = 0; i != 1024; ++i)
+      values.push_back(values_t::Make(i));
+
+    ring_t ring(capacity);
+    // fault the storage in first, that is not what push costs in steady state
+    Fill(ring, values, capacity);
+    bench.measure(name("push"), testCase, operations,
+      [&] { Fill(ring, values, operations); });
+
+    bench.measure(name("emplace"), testCase, operations,
+      [&]
+      {
+        for (size_t i = 0; i != operations; ++i)
+          ring.emplace(values[i & 1023]);
+      });
+
+    size_t weight = 0;
+    bench.measure(name("index"), testCase, rounds * capacity,
+      [&]
+      {
+        for (size_t round = 0; round != rounds; ++round)
+          for (size_t i = 0; i != capacity; ++i)
+            weight += values_t::Weigh(ring[static_cast<unsigned>(i)]);
+      });
+
+    bench.measure(name("iterate"), testCase, rounds * capacity,
+      [&]
+      {
+        for (size_t round = 0; round != rounds; ++round)
+          ring.visit([&weight](const T& value) { weight += values_t::Weigh(value); });
+      });
+    Sink = weight;
+
+    // pop, clear and resize consume the ring, refill it between the timed parts
+    double popSeconds = 0, clearSeconds = 0;
+    for (size_t round = 0; round != rounds; ++round)
+    {
+      Fill(ring, values, capacity);
+      auto start = clock_t::now();
+      for (size_t i = 0; i != capacity; ++i)
+        ring.pop_front();
+      popSeconds += std::chrono::duration<double>(clock_t::now() - start).count();
+
+      Fill(ring, values, capacity);
+      start = clock_t::now();
+      ring.clear();
+      clearSeconds += std::chrono::duration<double>(clock_t::now() - start).count();
+    }
+    bench.record(name("pop_front"), testCase, rounds * capacity, popSeconds);
+    bench.record(name("clear"), testCase, rounds * capacity, clearSeconds);
+
+    if constexpr (!std::is_same_v<ring_t, DequeRing<T>>)
+    {
+      if (resizable)
+      {
+        // grow a wrapped ring to twice its size and shrink it back, both relocate every element
+        double resizeSeconds = 0;
+        const size_t resizeRounds = std::max<size_t>(rounds / 4, 1);
+        for (size_t round = 0; round != resizeRounds; ++round)
+        {
+          ring_t wrapped(capacity);
+          Fill(wrapped, values, capacity + capacity / 2);
+          auto start = clock_t::now();
+          wrapped.resize(capacity * 2);
+          wrapped.resize(capacity);
+          resizeSeconds += std::chrono::duration<double>(clock_t::now() - start).count();
+        }
+        bench.record(name("resize"), testCase, resizeRounds * capacity * 2, resizeSeconds);
+      }
+    }
+  }
+
+  template <typename T>
+  void RunAll(size_t bytes)
+  {
+    const size_t capacity = bytes / sizeof(T);
+    const std::string testCase = std::string{ Values<T>::NAME } + " " + std::to_string(bytes >> 10) + " KiB";
+    // resizing the DRAM sized rings takes as long as the rest together
+    const bool resizable = bytes <= (size_t{ 8 } << 20);
+    Run<CircularRing, T>("CircularBuffer", capacity, testCase, resizable);
+    Run<VectorRing, T>("vector ring", capacity, testCase, resizable);
+    Run<DequeRing, T>("std::deque", capacity, testCase, resizable);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  auto& bench = regit::benchmarking::TheBenchmark;
+  bench.ParseArguments(argc, argv);
+
+  // L1, L2, last level cache and DRAM sized rings (element storage only)
+  for (size_t bytes : { size_t{ 16 } << 10, size_t{ 256 } << 10, size_t{ 8 } << 20, size_t{ 256 } << 20 })
+    RunAll<uint64_t>(bytes);
+  for (size_t bytes : { size_t{ 16 } << 10, size_t{ 256 } << 10, size_t{ 8 } << 20, size_t{ 64 } << 20 })
+    RunAll<std::string>(bytes);
+
+  bench.Finish();
+}
@@ -0,0 +1,75 @@
+#include <containers/circular_buffer/include/circular_buffer.hpp>
+#include <containers/circular_buffer/include/columnar_circular_buffer.hpp>
+#include <simple_benchmark.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace
+{
+  volatile double Sink;
+
+  struct Tick
+  {
+    uint64_t Timestamp;
+    double Price;
+    int32_t Quantity;
+    char Side;
+  };
+
+  // per pass: the mean price over the whole ring
+  void Run(size_t capacity, size_t passes)
+  {
+    const std::string testCase = std::to_string(capacity * sizeof(Tick) / 1024) + " KiB of ticks";
+    auto& bench = regit::benchmarking::TheBenchmark;
+
+    regit::containers::CircularBuffer<Tick> records(capacity);
+    regit::containers::ColumnarCircularBuffer<uint64_t, double, int32_t, char> columns(capacity);
+    // wrap both rings so every scan covers two segments
+    for (size_t i = 0; i != capacity + capacity / 2; ++i)
+    {
+      Tick tick{ i, 100.0 + static_cast<double>(i % 97), static_cast<int32_t>(i % 13), i % 2 ? 'S' : 'B' };
+      records.push(tick);
+      columns.push(tick.Timestamp, tick.Price, tick.Quantity, tick.Side);
+    }
+
+    bench.measure("CircularBuffer<Tick>", testCase, passes * capacity,
+      [&records, passes]
+      {
+        for (size_t pass = 0; pass != passes; ++pass)
+        {
+          double sum = 0;
+          regit::containers::for_each(records.cbegin(), records.cend(), [&sum](const Tick& tick) { sum += tick.Price; });
+          Sink = sum / static_cast<double>(records.size());
+        }
+      });
+
+    bench.measure("ColumnarCircularBuffer", testCase, passes * capacity,
+      [&columns, passes]
+      {
+        for (size_t pass = 0; pass != passes; ++pass)
+        {
+          auto [one, two] = columns.column<1>();
+          double sum = 0;
+          for (double price : one)
+            sum += price;
+          for (double price : two)
+            sum += price;
+          Sink = sum / static_cast<double>(columns.size());
+        }
+      });
+  }
+}
+
+int main(int argc, char** argv)
+{
+  auto& bench = regit::benchmarking::TheBenchmark;
+  bench.ParseArguments(argc, argv);
+
+  // from L1 resident to well past the last level cache
+  for (size_t capacity : { 1'000, 30'000, 1'000'000, 10'000'000 })
+    Run(capacity, bench.scale(std::max<size_t>(200'000'000 / capacity, 2)));
+
+  bench.Finish();
+}
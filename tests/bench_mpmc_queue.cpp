@@ -0,0 +1,115 @@
+#include <containers/circular_buffer/include/circular_buffer.hpp>
+#include <containers/mpmc_queue/include/mpmc_queue.hpp>
+#include <simple_benchmark.hpp>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  constexpr size_t QUEUE_CAPACITY = 1024;
+
+  // the baseline every producer fans into today: a CircularBuffer behind one lock
+  class LockedCircularBuffer
+  {
+  public:
+    explicit LockedCircularBuffer(size_t size)
+      : mBuffer(size)
+    { }
+
+    bool try_push(size_t value)
+    {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      if (mBuffer.size() == mBuffer.capacity())
+        return false;
+      mBuffer.emplace(value);
+      return true;
+    }
+
+    bool try_pop(size_t& value)
+    {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      if (mBuffer.empty())
+        return false;
+      // CircularBuffer only removes from the back, which costs the same as a FIFO pop here
+      value = mBuffer.back();
+      mBuffer.pop();
+      return true;
+    }
+
+  private:
+    std::mutex mMutex;
+    regit::containers::CircularBuffer<size_t> mBuffer;
+  };
+
+  // half of the threads produce, the other half consume; a single thread alternates both roles
+  template <typename QueueT>
+  void Run(const char* name, size_t threads, size_t operations)
+  {
+    QueueT queue(QUEUE_CAPACITY);
+    std::string testCase = std::to_string(threads) + " threads";
+
+    regit::benchmarking::TheBenchmark.measure(name, testCase, operations,
+      [&queue, threads, operations]
+      {
+        if (threads == 1)
+        {
+          size_t value = 0;
+          for (size_t i = 0; i != operations; ++i)
+          {
+            queue.try_push(i);
+            queue.try_pop(value);
+          }
+          return;
+        }
+
+        const size_t producers = threads / 2;
+        const size_t consumers = threads - producers;
+        std::vector<std::thread> workers;
+
+        for (size_t p = 0; p != producers; ++p)
+        {
+          workers.emplace_back(
+            [&queue, p, producers, operations]
+            {
+              for (size_t i = p; i < operations; i += producers)
+                while (!queue.try_push(i))
+                  std::this_thread::yield();
+            });
+        }
+
+        // every consumer drains a fixed share so they do not need a shared counter
+        for (size_t c = 0; c != consumers; ++c)
+        {
+          size_t share = operations / consumers + (c < operations % consumers);
+          workers.emplace_back(
+            [&queue, share]
+            {
+              size_t value = 0;
+              for (size_t i = 0; i != share; ++i)
+                while (!queue.try_pop(value))
+                  std::this_thread::yield();
+            });
+        }
+
+        for (auto& worker : workers)
+          worker.join();
+      });
+  }
+}
+
+int main(int argc, char** argv)
+{
+  auto& bench = regit::benchmarking::TheBenchmark;
+  bench.ParseArguments(argc, argv);
+  const size_t operations = bench.scale(4'000'000);
+
+  for (size_t threads : { 1, 2, 4, 8, 16, 32 })
+  {
+    Run<regit::containers::MpmcQueue<size_t>>("MpmcQueue", threads, operations);
+    Run<LockedCircularBuffer>("mutex + CircularBuffer", threads, operations);
+  }
+
+  bench.Finish();
+}
@@ -0,0 +1,70 @@
+#include <containers/circular_buffer/include/order_statistics_window.hpp>
+#include <simple_benchmark.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+  volatile double Sink;
+
+  // per tick: push one sample, then ask for p50 and p99
+  void Run(size_t window, size_t ticks)
+  {
+    std::mt19937_64 engine{ 1 };
+    std::lognormal_distribution<double> latencies{ 3.0, 0.5 };
+    std::vector<double> samples(window + ticks);
+    for (auto& sample : samples)
+      sample = latencies(engine);
+
+    const std::string testCase = "window " + std::to_string(window);
+    auto& bench = regit::benchmarking::TheBenchmark;
+
+    regit::containers::OrderStatisticsWindow<double> tree(window);
+    for (size_t i = 0; i != window; ++i)
+      tree.push(samples[i]);
+    bench.measure("OrderStatisticsWindow", testCase, ticks,
+      [&tree, &samples, window, ticks]
+      {
+        for (size_t i = 0; i != ticks; ++i)
+        {
+          tree.push(samples[window + i]);
+          Sink = tree.quantile(0.5) + tree.quantile(0.99);
+        }
+      });
+
+    regit::containers::CircularBuffer<double> ring(window);
+    ring.push_range(samples.data(), samples.data() + window);
+    std::vector<double> scratch(window);
+    bench.measure("copy + nth_element", testCase, ticks,
+      [&ring, &samples, &scratch, window, ticks]
+      {
+        for (size_t i = 0; i != ticks; ++i)
+        {
+          ring.push(samples[window + i]);
+          regit::containers::copy(ring.cbegin(), ring.cend(), scratch.begin());
+          auto p50 = scratch.begin() + static_cast<std::ptrdiff_t>(0.5 * static_cast<double>(window - 1) + 0.5);
+          auto p99 = scratch.begin() + static_cast<std::ptrdiff_t>(0.99 * static_cast<double>(window - 1) + 0.5);
+          std::nth_element(scratch.begin(), p50, scratch.end());
+          std::nth_element(p50, p99, scratch.end());
+          Sink = *p50 + *p99;
+        }
+      });
+  }
+}
+
+int main(int argc, char** argv)
+{
+  auto& bench = regit::benchmarking::TheBenchmark;
+  bench.ParseArguments(argc, argv);
+
+  for (size_t window : { 1'000, 10'000, 100'000, 1'000'000 })
+  {
+    // keep the baseline at roughly the same total work for every window size
+    size_t ticks = bench.scale(std::max<size_t>(20'000'000 / window, 20));
+    Run(window, ticks);
+  }
+
+  bench.Finish();
+}
@@ -0,0 +1,90 @@
+#include <async/include/parallel.hpp>
+#include <async/include/thread_pool.hpp>
+#include <simple_benchmark.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace
+{
+  using SharedQueueThreadPool = regit::async::GenericThreadPool<>;
+
+  // a few hundred nanoseconds of work, small enough that scheduling dominates
+  void Work(std::atomic<size_t>& done)
+  {
+    volatile size_t sink = 0;
+    for (size_t i = 0; i != 64; ++i)
+      sink = sink + i;
+    done.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void WaitFor(const std::atomic<size_t>& done, size_t tasks)
+  {
+    while (done.load(std::memory_order_relaxed) != tasks)
+      std::this_thread::yield();
+  }
+
+  // "post": every task comes from outside the pool. "spawn": one root task per worker
+  // posts its share from inside the pool, the shape nested parallelism produces.
+  // "parallel_for": the same work as one ParallelFor over single elements
+  template <typename PoolT>
+  void Run(const char* name, size_t threads, size_t tasks)
+  {
+    auto& bench = regit::benchmarking::TheBenchmark;
+    std::string testCase = std::to_string(threads) + " threads";
+
+    PoolT pool{threads};
+    pool.Start();
+
+    std::atomic<size_t> done{0};
+    bench.measure(std::string{ name } + "::post", testCase, tasks,
+      [&]
+      {
+        for (size_t i = 0; i != tasks; ++i)
+          pool.Post([&done] { Work(done); });
+        WaitFor(done, tasks);
+      });
+
+    done = 0;
+    bench.measure(std::string{ name } + "::spawn", testCase, tasks,
+      [&]
+      {
+        for (size_t root = 0; root != threads; ++root)
+        {
+          size_t share = tasks / threads + (root < tasks % threads);
+          pool.Post(
+            [&pool, &done, share]
+            {
+              for (size_t i = 0; i != share; ++i)
+                pool.Post([&done] { Work(done); });
+            });
+        }
+        WaitFor(done, tasks);
+      });
+
+    done = 0;
+    bench.measure(std::string{ name } + "::parallel_for", testCase, tasks,
+      [&]
+      {
+        regit::async::ParallelFor(pool, size_t{ 0 }, tasks, 1, [&done](size_t) { Work(done); });
+      });
+
+    pool.Stop();
+  }
+}
+
+int main(int argc, char** argv)
+{
+  auto& bench = regit::benchmarking::TheBenchmark;
+  bench.ParseArguments(argc, argv);
+  const size_t tasks = bench.scale(2'000'000);
+
+  for (size_t threads : { 1, 2, 4, 8, 16, 32, 64 })
+  {
+    Run<regit::async::WorkStealingThreadPool>("work stealing", threads, tasks);
+    Run<SharedQueueThreadPool>("shared queue", threads, tasks);
+  }
+
+  bench.Finish();
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace regit::benchmarking {
+
+class Benchmark final
+{
+private:
+  using clock_t = std::chrono::steady_clock;
+
+  struct Result
+  {
+    std::string Name;
+    std::string Case;
+    size_t Operations;
+    double Seconds;
+  };
+
+public:
+  // --csv <path> writes machine-readable results, --quick scales the workloads down
+  void ParseArguments(int argc, char** argv)
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      if (!std::strcmp(argv[i], "--quick"))
+        Quick = true;
+      else if (!std::strcmp(argv[i], "--csv") && i + 1 < argc)
+        CsvPath = argv[++i];
+    }
+  }
+
+  size_t scale(size_t operations) const noexcept
+  {
+    return Quick ? std::max<size_t>(operations / 100, 1) : operations;
+  }
+
+  // runs functor once and records how long it took to perform the given number of operations
+  template <typename StringT1, typename StringT2, typename FunctorT>
+  void measure(StringT1&& name, StringT2&& testCase, size_t operations, FunctorT&& functor)
+  {
+    auto start = clock_t::now();
+    functor();
+    std::chrono::duration<double> elapsed = clock_t::now() - start;
+    record(std::forward<StringT1>(name), std::forward<StringT2>(testCase), operations, elapsed.count());
+  }
+
+  // records a result timed by the caller, for operations that need untimed setup between runs
+  template <typename StringT1, typename StringT2>
+  void record(StringT1&& name, StringT2&& testCase, size_t operations, double seconds)
+  {
+    Results.push_back(Result{
+      std::forward<StringT1>(name), std::forward<StringT2>(testCase), operations, seconds});
+    Print(Results.back());
+  }
+
+  void Finish() const
+  {
+    if (CsvPath.empty())
+      return;
+
+    std::ofstream file{CsvPath};
+    file << "name,case,operations,seconds,ns_per_op,ops_per_second\n";
+    for (const auto& result : Results)
+    {
+      file << result.Name << ',' << result.Case << ',' << result.Operations << ','
+        << result.Seconds << ',' << NanosecondsPerOperation(result) << ','
+        << OperationsPerSecond(result) << '\n';
+    }
+  }
+
+private:
+  static double NanosecondsPerOperation(const Result& result) noexcept
+  {
+    return result.Operations ? result.Seconds * 1e9 / static_cast<double>(result.Operations) : 0.0;
+  }
+
+  static double OperationsPerSecond(const Result& result) noexcept
+  {
+    return result.Seconds > 0.0 ? static_cast<double>(result.Operations) / result.Seconds : 0.0;
+  }
+
+  static void Print(const Result& result)
+  {
+    std::cout << std::left << std::setw(32) << result.Name
+      << std::setw(24) << result.Case << std::right << std::fixed
+      << std::setw(12) << std::setprecision(2) << NanosecondsPerOperation(result) << " ns/op"
+      << std::setw(16) << std::setprecision(0) << OperationsPerSecond(result) << " ops/s"
+      << std::endl;
+  }
+
+  std::vector<Result> Results;
+  std::string CsvPath;
+  bool Quick = false;
+};
+
+inline Benchmark TheBenchmark;
+
+}
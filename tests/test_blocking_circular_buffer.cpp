@@ -0,0 +1,121 @@
+#include <containers/circular_buffer/include/blocking_circular_buffer.hpp>
+#include <simple_tester.hpp>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST_BEGIN(OverwriteAndReject)
+{
+  regit::containers::BlockingCircularBuffer<int, regit::containers::OverflowPolicy::Overwrite> telemetry(3);
+  for (int i = 0; i != 5; ++i)
+    EXPECT_TRUE(telemetry.push(i));
+  EXPECT_EQ(telemetry.size(), 3u);
+
+  int value = -1;
+  EXPECT_TRUE(telemetry.try_pop(value));
+  EXPECT_EQ(value, 2);
+
+  regit::containers::BlockingCircularBuffer<int, regit::containers::OverflowPolicy::Reject> orders(3);
+  for (int i = 0; i != 3; ++i)
+    EXPECT_TRUE(orders.push(i));
+  EXPECT_FALSE(orders.push(3));
+  EXPECT_FALSE(orders.emplace(4));
+  EXPECT_EQ(orders.size(), 3u);
+  EXPECT_TRUE(orders.try_pop(value));
+  EXPECT_EQ(value, 0);
+  EXPECT_TRUE(orders.push(3));
+
+  regit::containers::CircularBuffer<int> plain(2);
+  EXPECT_TRUE(plain.try_push(1));
+  EXPECT_TRUE(plain.try_emplace(2));
+  EXPECT_TRUE(plain.full());
+  EXPECT_FALSE(plain.try_push(3));
+  EXPECT_EQ(plain.front(), 1);
+  EXPECT_EQ(plain.back(), 2);
+}
+TEST_END
+
+TEST_BEGIN(BlockWithTimeout)
+{
+  regit::containers::BlockingCircularBuffer<int> queue(2);
+  EXPECT_TRUE(queue.push(1));
+  EXPECT_TRUE(queue.push(2));
+  EXPECT_FALSE(queue.push_for(3, 5ms));
+
+  int value = 0;
+  EXPECT_TRUE(queue.pop_for(value, 5ms));
+  EXPECT_EQ(value, 1);
+  EXPECT_TRUE(queue.push_for(3, 5ms));
+
+  EXPECT_TRUE(queue.pop(value));
+  EXPECT_TRUE(queue.pop(value));
+  EXPECT_EQ(value, 3);
+  EXPECT_FALSE(queue.pop_for(value, 5ms));
+  EXPECT_FALSE(queue.try_pop(value));
+}
+TEST_END
+
+TEST_BEGIN(Backpressure)
+{
+  constexpr int producers = 4;
+  constexpr int perProducer = 50'000;
+  regit::containers::BlockingCircularBuffer<int> queue(16);
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p != producers; ++p)
+    threads.emplace_back([&queue, p] {
+      for (int i = 0; i != perProducer; ++i)
+        queue.push(p * perProducer + i);
+    });
+
+  // nothing may be dropped, the producers have to wait for us instead
+  long long sum = 0, count = 0;
+  int value;
+  while (count != producers * perProducer && queue.pop(value))
+  {
+    sum += value;
+    ++count;
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  const long long total = static_cast<long long>(producers) * perProducer;
+  EXPECT_EQ(count, total);
+  EXPECT_EQ(sum, total * (total - 1) / 2);
+  EXPECT_TRUE(queue.empty());
+}
+TEST_END
+
+TEST_BEGIN(Close)
+{
+  regit::containers::BlockingCircularBuffer<int> queue(1);
+  EXPECT_TRUE(queue.push(7));
+
+  bool pushed = true;
+  std::thread producer{ [&] { pushed = queue.push(8); } };
+  std::this_thread::sleep_for(5ms);
+  queue.close();
+  producer.join();
+  EXPECT_FALSE(pushed);
+  EXPECT_TRUE(queue.closed());
+
+  // what is left is still handed out, then pop stops waiting
+  int value = 0;
+  EXPECT_TRUE(queue.pop(value));
+  EXPECT_EQ(value, 7);
+  EXPECT_FALSE(queue.pop(value));
+  EXPECT_FALSE(queue.push(9));
+}
+TEST_END
+
+int main(void)
+{
+  AddTestClose();
+  AddTestBackpressure();
+  AddTestBlockWithTimeout();
+  AddTestOverwriteAndReject();
+  regit::testing::RunAllTests();
+}
@@ -1,6 +1,12 @@
 #include <containers/circular_buffer/include/circular_buffer.hpp>
 #include <simple_tester.hpp>
 
+#include <list>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 namespace
 {
   template <typename T>
@@ -11,6 +17,76 @@ namespace
       std::cout << elem << ' ';
     std::cout << "\n";
   }
+
+  // stateful allocator that counts the live allocations of its arena
+  template <typename T>
+  struct ArenaAllocator
+  {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::true_type;
+
+    int* Live;
+
+    explicit ArenaAllocator(int* live) noexcept
+      : Live{ live }
+    { }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& rhs) noexcept
+      : Live{ rhs.Live }
+    { }
+
+    T* allocate(size_t count)
+    {
+      ++*Live;
+      return std::allocator<T>{ }.allocate(count);
+    }
+
+    void deallocate(T* pointer, size_t count) noexcept
+    {
+      --*Live;
+      std::allocator<T>{ }.deallocate(pointer, count);
+    }
+
+    bool operator==(const ArenaAllocator& rhs) const noexcept
+    {
+      return Live == rhs.Live;
+    }
+
+    bool operator!=(const ArenaAllocator& rhs) const noexcept
+    {
+      return Live != rhs.Live;
+    }
+  };
+
+  // copies throw once armed; the move is not noexcept, so relocating falls back to copying
+  struct ThrowingCopy
+  {
+    static inline int CopiesLeft = -1;
+
+    int Value;
+
+    explicit ThrowingCopy(int value) noexcept
+      : Value{ value }
+    { }
+
+    ThrowingCopy(const ThrowingCopy& rhs)
+      : Value{ rhs.Value }
+    {
+      if (CopiesLeft == 0)
+        throw std::runtime_error{ "copy failed!" };
+      if (CopiesLeft > 0)
+        --CopiesLeft;
+    }
+
+    ThrowingCopy(ThrowingCopy&& rhs)
+      : Value{ rhs.Value }
+    { }
+
+    ThrowingCopy& operator=(const ThrowingCopy&) = default;
+  };
 }
 
 TEST_BEGIN(Construction)
@@ -25,7 +101,42 @@ TEST_BEGIN(Construction)
 
   EXPECT_EQ(cb5.capacity(), cb4.size());
   EXPECT_EQ(cb4.back(), cb5.back());
-  EXPECT_EQ(cb.front(), 0xCC);
+  EXPECT_TRUE(cb.empty());
+}
+TEST_END
+
+TEST_BEGIN(SizeAndClear)
+{
+  regit::containers::CircularBuffer<unsigned char> cb1(3);
+  cb1.push(0xCC);
+  EXPECT_EQ(cb1.size(), 1u);
+  EXPECT_FALSE(cb1.empty());
+
+  cb1.push(0xCC);
+  cb1.push(0xCC);
+  cb1.push(0xCC);
+  EXPECT_EQ(cb1.size(), 3u);
+  cb1.pop();
+  EXPECT_EQ(cb1.size(), 2u);
+
+  cb1.clear();
+  EXPECT_TRUE(cb1.empty());
+  cb1.pop();
+  EXPECT_EQ(cb1.size(), 0u);
+
+  regit::containers::CircularBuffer<std::string> cb2(2);
+  cb2.emplace("first");
+  cb2.emplace("second");
+  cb2.emplace("third");
+  EXPECT_EQ(cb2.size(), 2u);
+  EXPECT_EQ(cb2.front(), "second");
+  EXPECT_EQ(cb2.back(), "third");
+  cb2.pop_front();
+  EXPECT_EQ(cb2.front(), "third");
+  EXPECT_EQ(cb2.size(), 1u);
+  cb2.emplace("fourth");
+  cb2.clear();
+  EXPECT_TRUE(cb2.empty());
 }
 TEST_END
 
@@ -122,6 +233,20 @@ TEST_BEGIN(Subscript)
 }
 TEST_END
 
+TEST_BEGIN(EmplaceBraceInitialises)
+{
+  regit::containers::CircularBuffer<std::vector<int>> cb(2);
+  cb.emplace(2, 5);
+  EXPECT_EQ(cb.back(), (std::vector<int>{ 2, 5 }));
+
+  // allocators without their own construct keep the same semantics
+  int live = 0;
+  regit::containers::CircularBuffer<std::vector<int>, ArenaAllocator<std::vector<int>>> arena(2, ArenaAllocator<std::vector<int>>{ &live });
+  arena.emplace(2, 5);
+  EXPECT_EQ(arena.back(), (std::vector<int>{ 2, 5 }));
+}
+TEST_END
+
 TEST_BEGIN(StlAlgorithm)
 {
   std::array<int, 10> arr{ 1,2,3,4,5,6,7,8,9,10 };
@@ -133,6 +258,7 @@ TEST_BEGIN(StlAlgorithm)
   std::fill(cb.begin(), cb.end(), 1);
 
   regit::containers::CircularBuffer<int> anotherCB(cb.size());
+  anotherCB.push_range(arr.begin(), arr.end());
   std::copy(cb.begin(), cb.end(), anotherCB.begin());
   auto iter = std::find(anotherCB.begin(), anotherCB.end(), sum);
 
@@ -152,17 +278,274 @@ TEST_BEGIN(Resize)
   cb.resize(3);
   cb.resize(5);
   EXPECT_EQ(cb.front(), cb.back());
+  EXPECT_EQ(cb.size(), 1u);
+
+  regit::containers::CircularBuffer<int> wrapped(4);
+  for (int i = 1; i <= 6; ++i)
+    wrapped.push(i);
+  wrapped.resize(8);
+  EXPECT_EQ(wrapped.size(), 4u);
+  EXPECT_EQ(wrapped[0], 3);
+  EXPECT_EQ(wrapped[3], 6);
+  wrapped.resize(2);
+  EXPECT_EQ(wrapped.front(), 5);
+  EXPECT_EQ(wrapped.back(), 6);
+}
+TEST_END
+
+TEST_BEGIN(BulkRanges)
+{
+  std::vector<int> values(10);
+  std::iota(values.begin(), values.end(), 1);
+
+  regit::containers::CircularBuffer<int> cb(8);
+  cb.push(0);
+  cb.push_range(values.data(), values.data() + 5);
+  EXPECT_EQ(cb.size(), 6u);
+  EXPECT_EQ(cb.back(), 5);
+
+  // wraps and overwrites the three oldest values
+  cb.push_range(values.data() + 5, values.data() + 10);
+  EXPECT_EQ(cb.size(), 8u);
+  EXPECT_EQ(cb.front(), 3);
+  EXPECT_EQ(cb.back(), 10);
+
+  auto one = cb.array_one();
+  auto two = cb.array_two();
+  EXPECT_EQ(one.size() + two.size(), cb.size());
+  EXPECT_EQ(one[0], 3);
+  EXPECT_EQ(two[two.size() - 1], 10);
+
+  int out[5] = {};
+  EXPECT_EQ(cb.pop_range(out, 5), 5u);
+  EXPECT_EQ(out[0], 3);
+  EXPECT_EQ(out[4], 7);
+  EXPECT_EQ(cb.size(), 3u);
+  EXPECT_EQ(cb.front(), 8);
+  EXPECT_TRUE(cb.array_two().empty());
+
+  std::vector<int> rest;
+  EXPECT_EQ(cb.pop_range(std::back_inserter(rest), 10), 3u);
+  EXPECT_EQ(rest, (std::vector<int>{ 8, 9, 10 }));
+  EXPECT_TRUE(cb.empty());
+
+  // more values than capacity only keeps the newest ones
+  cb.push_range(values.begin(), values.end());
+  EXPECT_EQ(cb.front(), 3);
+  EXPECT_EQ(cb.array_one().size(), 8u);
+}
+TEST_END
+
+TEST_BEGIN(BulkRangesNonTrivial)
+{
+  std::list<std::string> words{ "a", "b", "c", "d", "e" };
+  regit::containers::CircularBuffer<std::string> cb(4);
+  cb.push("z");
+  cb.push("y");
+  cb.push_range(words.begin(), words.end());
+  EXPECT_EQ(cb.size(), 4u);
+  EXPECT_EQ(cb.front(), "b");
+
+  std::string joined;
+  for (auto span : { cb.array_one(), cb.array_two() })
+    for (const auto& word : span)
+      joined += word;
+  EXPECT_EQ(joined, "bcde");
+
+  std::vector<std::string> out(2);
+  EXPECT_EQ(cb.pop_range(out.begin(), 2), 2u);
+  EXPECT_EQ(out[1], "c");
+  EXPECT_EQ(cb.front(), "d");
+}
+TEST_END
+
+TEST_BEGIN(LogicalOrderIterators)
+{
+  regit::containers::CircularBuffer<int> cb(5);
+  for (int i = 1; i <= 8; ++i)
+    cb.push(i);
+  cb.pop();
+
+  // storage is [6, 7, 8, 4, 5] with 8 popped, logical order is 4..7
+  std::vector<int> forward(cb.begin(), cb.end());
+  std::vector<int> backward(cb.rbegin(), cb.rend());
+  EXPECT_EQ(forward, (std::vector<int>{ 4, 5, 6, 7 }));
+  EXPECT_EQ(backward, (std::vector<int>{ 7, 6, 5, 4 }));
+  EXPECT_EQ(cb.end() - cb.begin(), 4);
+  EXPECT_EQ(cb.begin()[3], 7);
+
+  const auto& constCB = cb;
+  regit::containers::CircularBuffer<int>::const_iterator iter = cb.begin();
+  EXPECT_TRUE(iter == constCB.begin());
+
+  std::sort(cb.begin(), cb.end(), std::greater<int>{});
+  EXPECT_EQ(cb.front(), 7);
+  EXPECT_EQ(cb.back(), 4);
+}
+TEST_END
+
+TEST_BEGIN(SegmentedAlgorithms)
+{
+  regit::containers::CircularBuffer<int> cb(6);
+  for (int i = 1; i <= 9; ++i)
+    cb.push(i);
+
+  auto [one, two] = regit::containers::segments(cb.begin(), cb.end());
+  EXPECT_EQ(one.size(), 3u);
+  EXPECT_EQ(two.size(), 3u);
+  EXPECT_EQ(one[0], 4);
+  EXPECT_EQ(two[0], 7);
+
+  EXPECT_EQ(regit::containers::accumulate(cb.cbegin(), cb.cend(), 0), 4 + 5 + 6 + 7 + 8 + 9);
+  EXPECT_EQ(regit::containers::accumulate(cb.begin() + 1, cb.end() - 1, 1, std::multiplies<int>{}), 5 * 6 * 7 * 8);
+
+  int sum = 0;
+  regit::containers::for_each(cb.begin() + 4, cb.end(), [&sum](int value){ sum += value; });
+  EXPECT_EQ(sum, 8 + 9);
+
+  std::vector<int> out;
+  regit::containers::copy(cb.begin(), cb.end(), std::back_inserter(out));
+  EXPECT_EQ(out, (std::vector<int>{ 4, 5, 6, 7, 8, 9 }));
+
+  EXPECT_EQ(regit::containers::find(cb.begin(), cb.end(), 8) - cb.begin(), 4);
+  EXPECT_TRUE(regit::containers::find(cb.begin(), cb.end(), 1) == cb.end());
+
+  regit::containers::fill(cb.begin() + 2, cb.end(), 0);
+  EXPECT_EQ(regit::containers::accumulate(cb.begin(), cb.end(), 0), 4 + 5);
+}
+TEST_END
+
+TEST_BEGIN(AllocatorAware)
+{
+  using buffer_t = regit::containers::CircularBuffer<int, ArenaAllocator<int>>;
+  int first = 0, second = 0;
+  {
+    buffer_t a(4, ArenaAllocator<int>{ &first });
+    buffer_t b(2, ArenaAllocator<int>{ &second });
+    for (int i = 0; i != 6; ++i)
+      a.push(i);
+    EXPECT_EQ(first, 1);
+
+    // copies keep the allocator of the copy, moves take it along
+    buffer_t copy{ a };
+    EXPECT_EQ(first, 2);
+    EXPECT_TRUE(copy.get_allocator() == a.get_allocator());
+    buffer_t moved{ std::move(copy) };
+    EXPECT_EQ(first, 2);
+    EXPECT_EQ(moved.front(), 2);
+
+    // the allocators do not propagate, so b copies into its own arena
+    b = a;
+    EXPECT_EQ(first, 2);
+    EXPECT_EQ(second, 1);
+    EXPECT_TRUE(b.get_allocator() == ArenaAllocator<int>{ &second });
+    EXPECT_EQ(b.size(), 4u);
+    EXPECT_EQ(b.back(), 5);
+
+    b = std::move(moved);
+    EXPECT_EQ(first, 2);
+    EXPECT_EQ(second, 1);
+    EXPECT_EQ(b.front(), 2);
+
+    buffer_t other{ std::move(a), ArenaAllocator<int>{ &second } };
+    EXPECT_EQ(second, 2);
+    EXPECT_EQ(other.back(), 5);
+
+    b.swap(other);
+    EXPECT_EQ(b.size(), 4u);
+  }
+  EXPECT_EQ(first, 0);
+  EXPECT_EQ(second, 0);
+}
+TEST_END
+
+TEST_BEGIN(NonTrivialCopyAndResize)
+{
+  // long enough to live on the heap, a byte-wise copy would share or double free them
+  auto word = [](int i) { return std::string(32, static_cast<char>('a' + i)); };
+  regit::containers::CircularBuffer<std::string> cb(4);
+  for (int i = 0; i != 6; ++i)
+    cb.push(word(i));
+  EXPECT_FALSE(cb.array_two().empty());
+
+  regit::containers::CircularBuffer<std::string> copy{ cb };
+  EXPECT_TRUE(copy.array_two().empty());
+  EXPECT_EQ(copy.front(), word(2));
+  EXPECT_EQ(copy.back(), word(5));
+
+  regit::containers::CircularBuffer<std::string> assigned(2);
+  assigned.push(word(9));
+  assigned = cb;
+  cb.front() += "!";
+  EXPECT_EQ(assigned.size(), 4u);
+  EXPECT_EQ(assigned.front(), word(2));
+
+  cb.resize(8);
+  EXPECT_TRUE(cb.array_two().empty());
+  EXPECT_EQ(cb.capacity(), 8u);
+  EXPECT_EQ(cb.front(), word(2) + "!");
+  EXPECT_EQ(cb.back(), word(5));
+  cb.push(word(6));
+  EXPECT_EQ(cb.size(), 5u);
+
+  cb.resize(3);
+  EXPECT_EQ(cb.size(), 3u);
+  EXPECT_EQ(cb.front(), word(4));
+  EXPECT_EQ(cb.back(), word(6));
+  EXPECT_EQ(copy.back(), word(5));
+}
+TEST_END
+
+TEST_BEGIN(ResizeStrongGuarantee)
+{
+  regit::containers::CircularBuffer<ThrowingCopy> cb(4);
+  for (int i = 0; i != 6; ++i)
+    cb.emplace(i);
+  EXPECT_FALSE(cb.array_two().empty());
+
+  // the second kept element fails to copy, the dropped ones must still be there
+  ThrowingCopy::CopiesLeft = 1;
+  bool thrown = false;
+  try
+  {
+    cb.resize(2);
+  }
+  catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  ThrowingCopy::CopiesLeft = -1;
+  EXPECT_TRUE(thrown);
+  EXPECT_EQ(cb.capacity(), 4u);
+  EXPECT_EQ(cb.size(), 4u);
+  int expected = 2;
+  for (const auto& elem : cb)
+    EXPECT_EQ(elem.Value, expected++);
+
+  cb.resize(2);
+  EXPECT_EQ(cb.size(), 2u);
+  EXPECT_EQ(cb.front().Value, 4);
+  EXPECT_EQ(cb.back().Value, 5);
 }
 TEST_END
 
 int main(void)
 {
+  AddTestResizeStrongGuarantee();
+  AddTestNonTrivialCopyAndResize();
+  AddTestAllocatorAware();
+  AddTestSegmentedAlgorithms();
+  AddTestLogicalOrderIterators();
+  AddTestBulkRangesNonTrivial();
+  AddTestBulkRanges();
   AddTestResize();
   AddTestStlAlgorithm();
+  AddTestEmplaceBraceInitialises();
   AddTestSubscript();
   AddTestIterators();
   AddTestPushEmplacePop();
   AddTestAssignment();
   AddTestConstruction();
+  AddTestSizeAndClear();
   regit::testing::RunAllTests();
 }
\ No newline at end of file
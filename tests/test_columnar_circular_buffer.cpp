@@ -0,0 +1,84 @@
+#include <containers/circular_buffer/include/columnar_circular_buffer.hpp>
+#include <simple_tester.hpp>
+
+#include <cstdint>
+#include <numeric>
+
+namespace
+{
+  // ts, price, qty, side
+  using ticks_t = regit::containers::ColumnarCircularBuffer<uint64_t, double, int32_t, char>;
+
+  template <typename SpansT>
+  double Sum(const SpansT& spans)
+  {
+    double sum = 0;
+    for (auto value : spans.first)
+      sum += value;
+    for (auto value : spans.second)
+      sum += value;
+    return sum;
+  }
+}
+
+TEST_BEGIN(PushAndGather)
+{
+  ticks_t ticks(4);
+  for (int i = 0; i != 6; ++i)
+    ticks.push(static_cast<uint64_t>(i), 100.0 + i, i * 10, i % 2 ? 'S' : 'B');
+
+  EXPECT_EQ(ticks.size(), 4u);
+  EXPECT_TRUE(ticks.full());
+  EXPECT_EQ(ticks.get<0>(0), 2u);
+  EXPECT_EQ(ticks.get<2>(3), 50);
+  EXPECT_EQ(std::get<1>(ticks.front()), 102.0);
+  EXPECT_EQ(std::get<3>(ticks.back()), 'S');
+
+  ticks.push(std::make_tuple(uint64_t{ 6 }, 106.0, 60, 'B'));
+  EXPECT_EQ(ticks.get<0>(0), 3u);
+  ticks.get<2>(0) = -1;
+  EXPECT_EQ(std::get<2>(ticks[0]), -1);
+
+  ticks.pop();
+  ticks.pop_front();
+  EXPECT_EQ(ticks.size(), 2u);
+  EXPECT_EQ(ticks.get<0>(0), 4u);
+  EXPECT_EQ(std::get<0>(ticks.back()), 5u);
+}
+TEST_END
+
+TEST_BEGIN(ColumnSpans)
+{
+  ticks_t ticks(5);
+  for (int i = 0; i != 8; ++i)
+    ticks.push(static_cast<uint64_t>(i), 1.5 * i, i, 'B');
+
+  // 3..7 live, wrapped after 4
+  auto prices = ticks.column<1>();
+  EXPECT_EQ(prices.first.size(), 2u);
+  EXPECT_EQ(prices.second.size(), 3u);
+  EXPECT_EQ(Sum(prices), 1.5 * (3 + 4 + 5 + 6 + 7));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(prices.second.data()) % 64, 0u);
+
+  const ticks_t& view = ticks;
+  auto quantities = view.column<2>();
+  EXPECT_EQ(Sum(quantities), 3 + 4 + 5 + 6 + 7);
+
+  for (auto& qty : ticks.column<2>().first)
+    qty = 0;
+  EXPECT_EQ(ticks.get<2>(0), 0);
+
+  ticks_t copy{ ticks };
+  ticks.clear();
+  EXPECT_TRUE(ticks.empty());
+  EXPECT_EQ(Sum(copy.column<0>()), 3 + 4 + 5 + 6 + 7);
+  EXPECT_EQ(copy.get<2>(2), 5);
+}
+TEST_END
+
+int main(void)
+{
+  AddTestColumnSpans();
+  AddTestPushAndGather();
+  regit::testing::RunAllTests();
+}
@@ -0,0 +1,113 @@
+#include <containers/circular_buffer/include/compressed_circular_buffer.hpp>
+#include <simple_tester.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+  template <typename T, size_t BlockSize>
+  bool Matches(const regit::containers::CompressedCircularBuffer<T, BlockSize>& ring, const std::vector<T>& expected)
+  {
+    size_t i = 0;
+    for (T value : ring)
+    {
+      if (i == expected.size() || !(value == expected[i]))
+        return false;
+      ++i;
+    }
+    return i == expected.size();
+  }
+}
+
+TEST_BEGIN(IntegerCounters)
+{
+  regit::containers::CompressedCircularBuffer<int64_t, 128> ring(1024);
+  std::vector<int64_t> expected;
+  int64_t counter = 1'000'000'000'000;
+  for (int i = 0; i != 1000; ++i)
+  {
+    // steady rate with the occasional hiccup
+    counter += i % 100 == 0 ? 7919 : 1000;
+    ring.push(counter);
+    expected.push_back(counter);
+  }
+
+  EXPECT_EQ(ring.size(), 1000u);
+  EXPECT_EQ(ring.front(), expected.front());
+  EXPECT_EQ(ring.back(), counter);
+  EXPECT_TRUE(Matches(ring, expected));
+  EXPECT_TRUE(ring.memory_usage() * 5 < ring.size() * sizeof(int64_t));
+
+  // extremes still round-trip, they only cost more bits
+  regit::containers::CompressedCircularBuffer<int64_t, 16> extremes(64);
+  std::vector<int64_t> values{ 0, std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min(), -1, 1,
+    std::numeric_limits<int64_t>::min(), 42, 42, 42, -100'000, 100'000, 5, 5 };
+  for (int64_t value : values)
+    extremes.push(value);
+  EXPECT_TRUE(Matches(extremes, values));
+
+  regit::containers::CompressedCircularBuffer<uint8_t, 8> bytes(16);
+  std::vector<uint8_t> small;
+  for (int i = 0; i != 28; ++i)
+  {
+    bytes.push(static_cast<uint8_t>(i * 37));
+    small.push_back(static_cast<uint8_t>(i * 37));
+  }
+  // room for two sealed blocks, the third one pushed out the oldest 8 values
+  small.erase(small.begin(), small.begin() + 8);
+  EXPECT_EQ(bytes.size(), 20u);
+  EXPECT_TRUE(Matches(bytes, small));
+}
+TEST_END
+
+TEST_BEGIN(FloatingPoint)
+{
+  regit::containers::CompressedCircularBuffer<double, 256> ring(4096);
+  std::vector<double> expected;
+  double price = 101.25;
+  for (int i = 0; i != 3000; ++i)
+  {
+    // a slowly moving price on a tick grid
+    if (i % 16 == 0)
+      price += i % 32 == 0 ? 0.25 : -0.125;
+    ring.push(price);
+    expected.push_back(price);
+  }
+  EXPECT_TRUE(Matches(ring, expected));
+  EXPECT_EQ(ring.back(), price);
+  EXPECT_TRUE(ring.memory_usage() * 5 < ring.size() * sizeof(double));
+
+  std::mt19937_64 engine{ 7 };
+  std::normal_distribution<double> noise{ 0.0, 1e6 };
+  regit::containers::CompressedCircularBuffer<double, 32> random(100);
+  std::vector<double> values;
+  for (int i = 0; i != 170; ++i)
+  {
+    double value = i % 10 == 0 ? -0.0 : noise(engine);
+    random.push(value);
+    values.push_back(value);
+  }
+  values.push_back(std::numeric_limits<double>::infinity());
+  random.push(values.back());
+  values.erase(values.begin(), values.begin() + 32);
+  EXPECT_EQ(random.size(), values.size());
+  EXPECT_TRUE(Matches(random, values));
+
+  regit::containers::CompressedCircularBuffer<float, 4> floats(8);
+  std::vector<float> singles{ 1.5f, 1.75f, -3.0f, 1e-30f, 1e30f, 0.1f };
+  for (float value : singles)
+    floats.push(value);
+  EXPECT_TRUE(Matches(floats, singles));
+}
+TEST_END
+
+int main(void)
+{
+  AddTestFloatingPoint();
+  AddTestIntegerCounters();
+  regit::testing::RunAllTests();
+}
@@ -0,0 +1,247 @@
+#include <simple_tester.hpp>
+#include <async/include/coroutine.hpp>
+#include <async/include/thread_pool.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using regit::async::coro::SyncWait;
+using regit::async::coro::Task;
+using regit::async::coro::WhenAll;
+
+namespace
+{
+  Task<int> Value(int value)
+  {
+    co_return value;
+  }
+
+  Task<int> Sum(int count)
+  {
+    int sum = 0;
+    // every co_await completes synchronously; symmetric transfer only keeps the stack flat
+    // where gcc emits it as a tail call, test_coroutine_transfer covers that build
+    for (int i = 0; i != count; ++i)
+      sum += co_await Value(1);
+    co_return sum;
+  }
+
+  Task<std::thread::id> WorkerId(regit::async::WorkStealingThreadPool& pool)
+  {
+    co_await pool.Schedule();
+    co_return std::this_thread::get_id();
+  }
+
+  Task<void> Throws()
+  {
+    throw std::runtime_error{"handler failed"};
+    co_return;
+  }
+}
+
+TEST_BEGIN(LazyStart)
+{
+  bool started = false;
+  // a coroutine lambda has to outlive its frame, so it is never a temporary
+  auto start = [&started] () -> Task<int>
+  {
+    started = true;
+    co_return 7;
+  };
+  auto task = start();
+
+  EXPECT_FALSE(started);
+  EXPECT_EQ(SyncWait(std::move(task)), 7);
+  EXPECT_TRUE(started);
+}
+TEST_END
+
+TEST_BEGIN(DeepSynchronousChain)
+{
+  // short enough for any build to finish on the main thread's stack, even one that does
+  // not turn symmetric transfer into a tail call (-O0, sanitizers)
+  EXPECT_EQ(SyncWait(Sum(4000)), 4000);
+}
+TEST_END
+
+TEST_BEGIN(EmptyTaskThrows)
+{
+  int thrown = 0;
+  try
+  {
+    SyncWait(Task<int>{});
+  }
+  catch (const std::logic_error&)
+  {
+    ++thrown;
+  }
+
+  auto caller = [] () -> Task<int>
+  {
+    Task<int> empty;
+    co_return co_await std::move(empty);
+  };
+  try
+  {
+    SyncWait(caller());
+  }
+  catch (const std::logic_error&)
+  {
+    ++thrown;
+  }
+
+  std::vector<Task<int>> tasks;
+  tasks.push_back(Value(1));
+  tasks.emplace_back();
+  try
+  {
+    SyncWait(WhenAll(std::move(tasks)));
+  }
+  catch (const std::logic_error&)
+  {
+    ++thrown;
+  }
+  EXPECT_EQ(thrown, 3);
+}
+TEST_END
+
+TEST_BEGIN(ScheduleResumesOnWorker)
+{
+  regit::async::WorkStealingThreadPool pool{2};
+  pool.Start();
+
+  EXPECT_TRUE(SyncWait(WorkerId(pool)) != std::this_thread::get_id());
+
+  // the continuation of an awaited task resumes where the task finished
+  auto outer = [&pool] () -> Task<bool>
+  {
+    std::thread::id worker = co_await WorkerId(pool);
+    co_return worker == std::this_thread::get_id();
+  };
+  EXPECT_TRUE(SyncWait(outer()));
+  pool.Stop();
+}
+TEST_END
+
+TEST_BEGIN(ExceptionsPropagate)
+{
+  auto caller = [] () -> Task<int>
+  {
+    try
+    {
+      co_await Throws();
+    }
+    catch (const std::runtime_error&)
+    {
+      co_return 1;
+    }
+    co_return 0;
+  };
+  EXPECT_EQ(SyncWait(caller()), 1);
+
+  bool thrown = false;
+  try
+  {
+    SyncWait(Throws());
+  }
+  catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  EXPECT_TRUE(thrown);
+}
+TEST_END
+
+TEST_BEGIN(MoveOnlyResult)
+{
+  auto make = [] () -> Task<std::unique_ptr<int>> { co_return std::make_unique<int>(5); };
+  auto pointer = SyncWait(make());
+  EXPECT_EQ(*pointer, 5);
+}
+TEST_END
+
+TEST_BEGIN(ThousandsOfSuspendedCoroutines)
+{
+  regit::async::GenericThreadPool pool{size_t{4}};
+  pool.Start();
+
+  constexpr int count = 10000;
+  std::atomic_int parked = 0;
+  std::atomic_int peak = 0;
+  auto handler = [&pool, &parked, &peak] (int request) -> Task<int>
+  {
+    parked.fetch_add(1);
+    co_await pool.Schedule();
+    int now = parked.fetch_sub(1);
+    for (int seen = peak.load(); now > seen && !peak.compare_exchange_weak(seen, now); );
+    co_return request * 2;
+  };
+
+  // hold every worker until all handlers are parked in the queue, nothing resumes before
+  for (int i = 0; i != 4; ++i)
+    pool.Post(
+      [&parked]
+      {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (parked.load() != count && std::chrono::steady_clock::now() < deadline)
+          std::this_thread::yield();
+      });
+
+  std::vector<Task<int>> requests;
+  for (int i = 0; i != count; ++i)
+    requests.push_back(handler(i));
+
+  auto results = SyncWait(WhenAll(std::move(requests)));
+  EXPECT_EQ(peak, count);
+  EXPECT_EQ(parked, 0);
+  EXPECT_EQ(results.size(), size_t{count});
+
+  bool ordered = true;
+  for (int i = 0; i != count; ++i)
+    ordered = ordered && results[i] == i * 2;
+  EXPECT_TRUE(ordered);
+
+  std::atomic_int done = 0;
+  auto notify = [&pool, &done] () -> Task<void> { co_await pool.Schedule(); ++done; };
+  std::vector<Task<void>> voids;
+  for (int i = 0; i != 100; ++i)
+    voids.push_back(notify());
+  SyncWait(WhenAll(std::move(voids)));
+  EXPECT_EQ(done, 100);
+
+  SyncWait(WhenAll(std::vector<Task<void>>{}));
+  pool.Stop();
+}
+TEST_END
+
+TEST_BEGIN(FramesAreRecycled)
+{
+  using regit::async::coro::detail::FrameAllocator;
+  void* first = FrameAllocator::Allocate(200);
+  FrameAllocator::Deallocate(first, 200);
+  // same size class, straight from the free list
+  void* second = FrameAllocator::Allocate(250);
+  EXPECT_TRUE(first == second);
+  FrameAllocator::Deallocate(second, 250);
+
+  void* large = FrameAllocator::Allocate(1 << 16);
+  FrameAllocator::Deallocate(large, 1 << 16);
+}
+TEST_END
+
+int main(void)
+{
+  AddTestFramesAreRecycled();
+  AddTestThousandsOfSuspendedCoroutines();
+  AddTestMoveOnlyResult();
+  AddTestExceptionsPropagate();
+  AddTestScheduleResumesOnWorker();
+  AddTestEmptyTaskThrows();
+  AddTestDeepSynchronousChain();
+  AddTestLazyStart();
+  regit::testing::RunAllTests();
+}
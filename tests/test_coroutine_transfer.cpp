@@ -0,0 +1,35 @@
+#include <simple_tester.hpp>
+#include <async/include/coroutine.hpp>
+
+using regit::async::coro::SyncWait;
+using regit::async::coro::Task;
+
+namespace
+{
+  Task<int> Value(int value)
+  {
+    co_return value;
+  }
+
+  Task<int> Sum(int count)
+  {
+    int sum = 0;
+    for (int i = 0; i != count; ++i)
+      sum += co_await Value(1);
+    co_return sum;
+  }
+}
+
+// A million awaits that all complete synchronously. Without the symmetric transfer tail
+// call every one of them would leave frames on the stack and overflow it long before the end
+TEST_BEGIN(DeepSynchronousChain)
+{
+  EXPECT_EQ(SyncWait(Sum(1000000)), 1000000);
+}
+TEST_END
+
+int main(void)
+{
+  AddTestDeepSynchronousChain();
+  regit::testing::RunAllTests();
+}
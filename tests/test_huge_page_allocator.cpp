@@ -0,0 +1,112 @@
+#include <containers/circular_buffer/include/circular_buffer.hpp>
+#include <memory/include/huge_page_allocator.hpp>
+#include <simple_tester.hpp>
+
+#include <cstdint>
+#include <system_error>
+
+TEST_BEGIN(SmallAndLarge)
+{
+  regit::memory::HugePageAllocator<int> alloc;
+  EXPECT_EQ(alloc.node(), -1);
+
+  int* small = alloc.allocate(16);
+  small[15] = 15;
+  EXPECT_EQ(small[15], 15);
+  alloc.deallocate(small, 16);
+
+  // 3 MB is mapped as two whole huge pages
+  const size_t count = (size_t{ 3 } << 20) / sizeof(int);
+  int* large = alloc.allocate(count);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % (size_t{ 2 } << 20), 0u);
+  for (size_t i = 0; i != count; ++i)
+    large[i] = static_cast<int>(i);
+  EXPECT_EQ(large[count - 1], static_cast<int>(count - 1));
+  alloc.deallocate(large, count);
+}
+TEST_END
+
+TEST_BEGIN(NodeBinding)
+{
+  regit::memory::HugePageAllocator<char> local{ 0 };
+  char* bytes = local.allocate(size_t{ 4 } << 20);
+  bytes[0] = 'a';
+  bytes[(size_t{ 4 } << 20) - 1] = 'z';
+  EXPECT_EQ(bytes[0], 'a');
+  local.deallocate(bytes, size_t{ 4 } << 20);
+
+  bool threw = false;
+  try
+  {
+    regit::memory::HugePageAllocator<char>{ 4096 }.allocate(size_t{ 4 } << 20);
+  }
+  catch (const std::system_error&)
+  {
+    threw = true;
+  }
+  EXPECT_TRUE(threw);
+}
+TEST_END
+
+TEST_BEGIN(CircularBufferStorage)
+{
+  using allocator_t = regit::memory::HugePageAllocator<long long>;
+  regit::containers::CircularBuffer<long long, allocator_t> ring(1 << 20, allocator_t{ 0 });
+  for (long long i = 0; i != (1 << 20) + 10; ++i)
+    ring.push(i);
+  EXPECT_EQ(ring.front(), 10);
+  EXPECT_EQ(ring.get_allocator().node(), 0);
+
+  regit::containers::CircularBuffer<long long, allocator_t> copy{ ring };
+  EXPECT_EQ(copy.get_allocator().node(), 0);
+  EXPECT_EQ(copy.back(), (1 << 20) + 9);
+
+  // small rings stay on the heap
+  regit::containers::CircularBuffer<long long, allocator_t> small(8);
+  small = std::move(copy);
+  EXPECT_EQ(small.size(), size_t{ 1 } << 20);
+}
+TEST_END
+
+TEST_BEGIN(GrowInPlace)
+{
+  using allocator_t = regit::memory::HugePageAllocator<long long>;
+  const long long count = 1 << 19;
+  regit::containers::CircularBuffer<long long, allocator_t> ring(static_cast<size_t>(count));
+  for (long long i = 0; i != count + 1000; ++i)
+    ring.push(i);
+
+  // wrapped ring: the 1000 newest elements sit at the start of the storage
+  ring.resize(static_cast<size_t>(count) * 2);
+  EXPECT_TRUE(ring.array_two().empty());
+  EXPECT_EQ(ring.size(), static_cast<size_t>(count));
+  EXPECT_EQ(ring.front(), 1000);
+  EXPECT_EQ(ring.back(), count + 999);
+  bool ordered = true;
+  for (size_t i = 0; i != ring.size(); ++i)
+    ordered &= ring[static_cast<unsigned>(i)] == 1000 + static_cast<long long>(i);
+  EXPECT_TRUE(ordered);
+
+  ring.push(-1);
+  EXPECT_EQ(ring.back(), -1);
+
+  // shrinking below the threshold moves the newest elements to the heap
+  ring.resize(16);
+  EXPECT_EQ(ring.front(), count + 999 - 14);
+  EXPECT_EQ(ring.back(), -1);
+
+  allocator_t alloc;
+  long long* small = alloc.allocate(16);
+  EXPECT_TRUE(alloc.reallocate(small, 16, 1 << 20) == nullptr);
+  alloc.deallocate(small, 16);
+}
+TEST_END
+
+int main(void)
+{
+  AddTestGrowInPlace();
+  AddTestCircularBufferStorage();
+  AddTestNodeBinding();
+  AddTestSmallAndLarge();
+  regit::testing::RunAllTests();
+}
@@ -0,0 +1,106 @@
+#include <containers/circular_buffer/include/mirrored_circular_buffer.hpp>
+#include <simple_tester.hpp>
+
+#include <numeric>
+#include <string>
+#include <vector>
+
+TEST_BEGIN(Capacity)
+{
+  regit::containers::MirroredCircularBuffer<char> cb1(100);
+  regit::containers::MirroredCircularBuffer<int> cb2(1);
+  const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+  EXPECT_EQ(cb1.capacity(), page);
+  EXPECT_EQ(cb2.capacity() * sizeof(int) % page, 0u);
+  EXPECT_TRUE(cb1.empty());
+}
+TEST_END
+
+TEST_BEGIN(ContiguousAcrossWrap)
+{
+  regit::containers::MirroredCircularBuffer<int> cb(1);
+  const int capacity = static_cast<int>(cb.capacity());
+
+  // push past the end of the storage so the contents wrap
+  for (int i = 0; i != capacity + capacity / 2; ++i)
+    cb.push(i);
+
+  EXPECT_TRUE(cb.full());
+  EXPECT_EQ(cb.front(), capacity / 2);
+
+  bool contiguous = true;
+  const int* values = cb.data();
+  for (int i = 0; i != capacity; ++i)
+    contiguous = contiguous && values[i] == capacity / 2 + i;
+  EXPECT_TRUE(contiguous);
+
+  long long sum = std::accumulate(cb.begin(), cb.end(), 0LL);
+  long long first = capacity / 2, last = first + capacity - 1;
+  EXPECT_EQ(sum, (first + last) * capacity / 2);
+}
+TEST_END
+
+TEST_BEGIN(WriteCommitConsume)
+{
+  regit::containers::MirroredCircularBuffer<char> cb(1);
+  const size_t capacity = cb.capacity();
+
+  std::vector<char> filler(capacity - 3, 'x');
+  cb.push_range(filler.data(), filler.data() + filler.size());
+  cb.consume(filler.size());
+  EXPECT_TRUE(cb.empty());
+
+  // a record written across the physical end of the storage
+  const char message[] = "split-record";
+  EXPECT_TRUE(cb.write_capacity() >= sizeof(message));
+  std::memcpy(cb.write_data(), message, sizeof(message));
+  cb.commit(sizeof(message));
+
+  EXPECT_EQ(std::string(cb.data()), std::string(message));
+  cb.consume(6);
+  EXPECT_EQ(std::string(cb.data()), "record");
+
+  // an over-long commit stops at the capacity
+  cb.commit(capacity * 2);
+  EXPECT_TRUE(cb.full());
+  EXPECT_EQ(cb.size(), capacity);
+  EXPECT_EQ(cb.write_capacity(), 0u);
+}
+TEST_END
+
+TEST_BEGIN(NonTrivial)
+{
+  regit::containers::MirroredCircularBuffer<std::string> cb(1);
+  const size_t capacity = cb.capacity();
+  // wraps the start more than once, so elements sit across both mappings
+  const size_t count = capacity * 3 + 2;
+  for (size_t i = 0; i != count; ++i)
+    cb.emplace(std::to_string(i));
+
+  EXPECT_EQ(cb.front(), std::to_string(count - capacity));
+  EXPECT_EQ(cb.back(), std::to_string(count - 1));
+  cb.back() = "a value too long for the small string buffer";
+  cb.front() += "x";
+  cb.pop();
+  cb.pop_front();
+  EXPECT_EQ(cb.size(), capacity - 2);
+  EXPECT_EQ(cb[0], std::to_string(count - capacity + 1));
+
+  const std::string values[] = { "a", "b", "c" };
+  cb.push_range(std::begin(values), std::end(values));
+  EXPECT_EQ(cb.back(), "c");
+  cb.consume(capacity / 2);
+  cb.clear();
+  EXPECT_TRUE(cb.empty());
+}
+TEST_END
+
+int main(void)
+{
+  AddTestNonTrivial();
+  AddTestWriteCommitConsume();
+  AddTestContiguousAcrossWrap();
+  AddTestCapacity();
+  regit::testing::RunAllTests();
+}
@@ -0,0 +1,73 @@
+#include <containers/mpmc_queue/include/mpmc_queue.hpp>
+#include <simple_tester.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_BEGIN(TryPushPop)
+{
+  regit::containers::MpmcQueue<std::string> queue(3);
+  EXPECT_EQ(queue.capacity(), 4u);
+
+  for (int i = 0; i != 4; ++i)
+    EXPECT_TRUE(queue.try_push(std::to_string(i)));
+  EXPECT_FALSE(queue.try_emplace("full"));
+  EXPECT_EQ(queue.size(), 4u);
+
+  std::string value, result;
+  EXPECT_TRUE(queue.try_pop(value));
+  EXPECT_TRUE(queue.try_emplace("4"));
+  result += value;
+  while (queue.try_pop(value))
+    result += value;
+
+  EXPECT_EQ(result, "01234");
+  EXPECT_TRUE(queue.empty());
+}
+TEST_END
+
+TEST_BEGIN(MultipleProducersConsumers)
+{
+  constexpr long long perProducer = 100'000;
+  constexpr int producers = 4, consumers = 4;
+  regit::containers::MpmcQueue<long long> queue(256);
+  std::atomic<long long> sum{ 0 };
+  std::vector<std::thread> threads;
+
+  for (int p = 0; p != producers; ++p)
+    threads.emplace_back(
+      [&queue]
+      {
+        for (long long i = 1; i <= perProducer; ++i)
+          queue.push(i);
+      });
+
+  for (int c = 0; c != consumers; ++c)
+    threads.emplace_back(
+      [&queue, &sum]
+      {
+        long long value = 0, local = 0;
+        for (long long i = 0; i != perProducer; ++i)
+        {
+          queue.pop(value);
+          local += value;
+        }
+        sum += local;
+      });
+
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(sum.load(), producers * perProducer * (perProducer + 1) / 2);
+  EXPECT_TRUE(queue.empty());
+}
+TEST_END
+
+int main(void)
+{
+  AddTestMultipleProducersConsumers();
+  AddTestTryPushPop();
+  regit::testing::RunAllTests();
+}
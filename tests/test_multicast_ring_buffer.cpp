@@ -0,0 +1,158 @@
+#include <containers/circular_buffer/include/multicast_ring_buffer.hpp>
+#include <simple_tester.hpp>
+
+#include <thread>
+
+namespace
+{
+  struct Event
+  {
+    long long Value;
+    long long Risk;
+  };
+}
+
+TEST_BEGIN(ClaimAndPublish)
+{
+  regit::containers::MulticastRingBuffer<Event> ring(6);
+  EXPECT_EQ(ring.capacity(), 8u);
+  EXPECT_EQ(ring.cursor(), -1);
+
+  regit::containers::BatchConsumer<Event> consumer{ ring };
+  ring.add_gating_sequence(consumer.sequence());
+
+  // claim a batch of three and publish them with a single store
+  int64_t last = ring.claim(3);
+  for (int64_t sequence = last - 2; sequence <= last; ++sequence)
+    ring[sequence].Value = sequence * 10;
+  ring.publish(last);
+  ring.push(Event{ 30, 0 });
+
+  long long sum = 0;
+  bool endOfBatch = false;
+  size_t processed = consumer.process(
+    [&sum, &endOfBatch](Event& event, int64_t, bool end)
+    {
+      sum += event.Value;
+      endOfBatch = end;
+    });
+
+  EXPECT_EQ(processed, 4u);
+  EXPECT_EQ(sum, 0 + 10 + 20 + 30);
+  EXPECT_TRUE(endOfBatch);
+  EXPECT_EQ(consumer.sequence().load(), 3);
+}
+TEST_END
+
+TEST_BEGIN(ChainedConsumers)
+{
+  constexpr long long count = 500'000;
+  regit::containers::MulticastRingBuffer<Event> ring(1024);
+
+  // risk runs first, persistence only after risk, logging independently of both
+  regit::containers::BatchConsumer<Event> risk{ ring };
+  regit::containers::BatchConsumer<Event> persistence{ ring, { &risk.sequence() } };
+  regit::containers::BatchConsumer<Event> logging{ ring };
+  ring.add_gating_sequence(persistence.sequence());
+  ring.add_gating_sequence(logging.sequence());
+
+  long long riskSum = 0, loggingSum = 0;
+  bool ordered = true;
+  size_t persistenceBatches = 0;
+
+  std::thread riskThread{
+    [&]
+    {
+      risk.process_until(count - 1,
+        [&riskSum](Event& event, int64_t, bool)
+        {
+          event.Risk = event.Value * 2;
+          riskSum += event.Value;
+        });
+    }};
+  std::thread persistenceThread{
+    [&]
+    {
+      while (persistence.sequence().load() < count - 1)
+      {
+        persistence.process(
+          [&ordered](Event& event, int64_t sequence, bool)
+          {
+            // risk must already have written its result into the slot
+            ordered = ordered && event.Value == sequence && event.Risk == sequence * 2;
+          });
+        ++persistenceBatches;
+      }
+    }};
+  std::thread loggingThread{
+    [&]
+    {
+      logging.process_until(count - 1,
+        [&loggingSum](const Event& event, int64_t, bool) { loggingSum += event.Value; });
+    }};
+
+  for (long long i = 0; i != count; ++i)
+  {
+    int64_t sequence = ring.claim();
+    ring[sequence] = Event{ i, 0 };
+    ring.publish(sequence);
+  }
+
+  riskThread.join();
+  persistenceThread.join();
+  loggingThread.join();
+
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(riskSum, count * (count - 1) / 2);
+  EXPECT_EQ(loggingSum, riskSum);
+  EXPECT_TRUE(persistenceBatches <= static_cast<size_t>(count));
+}
+TEST_END
+
+TEST_BEGIN(Halt)
+{
+  regit::containers::MulticastRingBuffer<Event> ring(4);
+  regit::containers::BatchConsumer<Event> consumer{ ring };
+
+  size_t processed = 1;
+  std::thread waiting{
+    [&] { processed = consumer.process([](Event&, int64_t, bool) {}); }};
+  ring.halt();
+  waiting.join();
+
+  EXPECT_EQ(processed, 0u);
+
+  // a writer blocked on a full ring gives up instead of overwriting unread slots
+  regit::containers::MulticastRingBuffer<Event> full(4);
+  regit::containers::BatchConsumer<Event> stalled{ full };
+  full.add_gating_sequence(stalled.sequence());
+  for (int i = 0; i != 4; ++i)
+    EXPECT_TRUE(full.push(Event{ i, 0 }));
+
+  int64_t claimed = 0;
+  std::thread writer{ [&] { claimed = full.claim(); } };
+  full.halt();
+  writer.join();
+
+  EXPECT_EQ(claimed, full.CLAIM_FAILED);
+  EXPECT_FALSE(full.push(Event{ 4, 0 }));
+  EXPECT_EQ(full.cursor(), 3);
+}
+TEST_END
+
+TEST_BEGIN(ClaimLargerThanCapacity)
+{
+  regit::containers::MulticastRingBuffer<Event> ring(4);
+  EXPECT_EQ(ring.claim(5), ring.CLAIM_FAILED);
+  EXPECT_EQ(ring.claim(4), 3);
+}
+TEST_END
+
+int main(void)
+{
+  AddTestClaimLargerThanCapacity();
+  AddTestHalt();
+  AddTestChainedConsumers();
+  AddTestClaimAndPublish();
+  regit::testing::RunAllTests();
+}
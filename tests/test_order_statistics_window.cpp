@@ -0,0 +1,95 @@
+#include <containers/circular_buffer/include/order_statistics_window.hpp>
+#include <simple_tester.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+
+TEST_BEGIN(SmallWindow)
+{
+  regit::containers::OrderStatisticsWindow<int> window(5);
+  for (int value : { 9, 1, 7, 3, 5 })
+    window.push(value);
+
+  EXPECT_EQ(window.median(), 5);
+  EXPECT_EQ(window.quantile(0.0), 1);
+  EXPECT_EQ(window.quantile(1.0), 9);
+  EXPECT_EQ(window.rank(6), 3u);
+
+  // evicts 9 and 1
+  window.push(2);
+  window.push(2);
+  EXPECT_EQ(window.size(), 5u);
+  EXPECT_EQ(window.select(0), 2);
+  EXPECT_EQ(window.select(1), 2);
+  EXPECT_EQ(window.quantile(1.0), 7);
+  EXPECT_EQ(window.rank(2), 0u);
+  EXPECT_EQ(window.rank(3), 2u);
+
+  bool thrown = false;
+  try
+  {
+    window.select(5);
+  } catch (const std::out_of_range&)
+  {
+    thrown = true;
+  }
+  EXPECT_TRUE(thrown);
+}
+TEST_END
+
+TEST_BEGIN(ZeroWindow)
+{
+  regit::containers::OrderStatisticsWindow<int> window(0);
+  EXPECT_EQ(window.capacity(), 1u);
+  window.push(4);
+  window.push(8);
+  EXPECT_EQ(window.size(), 1u);
+  EXPECT_EQ(window.median(), 8);
+  EXPECT_EQ(window.rank(8), 0u);
+}
+TEST_END
+
+TEST_BEGIN(MatchesSortedCopy)
+{
+  std::mt19937 engine{ 7 };
+  std::uniform_int_distribution<int> latencies{ 0, 200 };
+
+  regit::containers::OrderStatisticsWindow<int> window(100);
+  std::deque<int> reference;
+  bool matches = true;
+  for (int i = 0; i != 3000; ++i)
+  {
+    int latency = latencies(engine);
+    window.push(latency);
+    reference.push_back(latency);
+    if (reference.size() > 100)
+      reference.pop_front();
+
+    std::vector<int> sorted(reference.begin(), reference.end());
+    std::sort(sorted.begin(), sorted.end());
+    size_t p99 = static_cast<size_t>(0.99 * static_cast<double>(sorted.size() - 1) + 0.5);
+    size_t below = static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), 100) - sorted.begin());
+
+    matches = matches
+      && window.quantile(0.99) == sorted[p99]
+      && window.select(sorted.size() / 2) == sorted[sorted.size() / 2]
+      && window.rank(100) == below;
+  }
+
+  EXPECT_TRUE(matches);
+  window.clear();
+  EXPECT_TRUE(window.empty());
+  window.push(4);
+  EXPECT_EQ(window.median(), 4);
+}
+TEST_END
+
+int main(void)
+{
+  AddTestMatchesSortedCopy();
+  AddTestZeroWindow();
+  AddTestSmallWindow();
+  regit::testing::RunAllTests();
+}
@@ -0,0 +1,167 @@
+#include <simple_tester.hpp>
+#include <async/include/parallel.hpp>
+#include <async/include/thread_pool.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using regit::async::IndexRange;
+using regit::async::ParallelFor;
+using regit::async::ParallelReduce;
+
+namespace
+{
+  template <typename PoolT>
+  bool VisitsEveryIndexOnce(PoolT& pool, size_t count, size_t grain)
+  {
+    std::vector<std::atomic_int> visits(count);
+    ParallelFor(pool, size_t{0}, count, grain, [&visits](size_t i) { ++visits[i]; });
+
+    for (auto& v : visits)
+      if (v != 1)
+        return false;
+    return true;
+  }
+}
+
+TEST_BEGIN(ParallelForSharedQueue)
+{
+  regit::async::GenericThreadPool pool{size_t{3}};
+  pool.Start();
+  EXPECT_TRUE(VisitsEveryIndexOnce(pool, 100000, 1));
+  EXPECT_TRUE(VisitsEveryIndexOnce(pool, 100000, 64));
+  EXPECT_TRUE(VisitsEveryIndexOnce(pool, 7, 100));
+}
+TEST_END
+
+TEST_BEGIN(ParallelForWorkStealing)
+{
+  regit::async::WorkStealingThreadPool pool{4};
+  pool.Start();
+  EXPECT_TRUE(VisitsEveryIndexOnce(pool, 100000, 1));
+  EXPECT_TRUE(VisitsEveryIndexOnce(pool, 100000, 64));
+  EXPECT_TRUE(VisitsEveryIndexOnce(pool, 1, 1));
+}
+TEST_END
+
+TEST_BEGIN(ParallelForCallerRunsEverythingOnStoppedPool)
+{
+  // nobody else picks the halves up, the caller has to run them all
+  regit::async::WorkStealingThreadPool pool{2};
+  EXPECT_TRUE(VisitsEveryIndexOnce(pool, 10000, 16));
+}
+TEST_END
+
+TEST_BEGIN(ParallelForSignedRange)
+{
+  regit::async::WorkStealingThreadPool pool{2};
+  pool.Start();
+
+  std::atomic<int64_t> sum = 0;
+  ParallelFor(pool, IndexRange<int>{-500, 500, 8}, [&sum](int i) { sum += i; });
+  EXPECT_EQ(sum.load(), -500);
+
+  int calls = 0;
+  ParallelFor(pool, 10, 10, 1, [&calls](int) { ++calls; });
+  ParallelFor(pool, 10, 5, 1, [&calls](int) { ++calls; });
+  EXPECT_EQ(calls, 0);
+}
+TEST_END
+
+TEST_BEGIN(NestedParallelFor)
+{
+  regit::async::WorkStealingThreadPool pool{3};
+  pool.Start();
+
+  // the inner loops run on workers, which help out instead of blocking
+  std::vector<std::atomic_int> visits(64 * 256);
+  ParallelFor(pool, 0, 64, 1,
+    [&](int row)
+    {
+      ParallelFor(pool, 0, 256, 16, [&](int column) { ++visits[row * 256 + column]; });
+    });
+
+  int once = 0;
+  for (auto& v : visits)
+    once += v == 1;
+  EXPECT_EQ(once, 64 * 256);
+}
+TEST_END
+
+TEST_BEGIN(ParallelForRethrows)
+{
+  regit::async::WorkStealingThreadPool pool{2};
+  pool.Start();
+
+  bool thrown = false;
+  try
+  {
+    ParallelFor(pool, 0, 10000, 4,
+      [](int i)
+      {
+        if (i == 5000)
+          throw std::runtime_error{"bad instrument"};
+      });
+  }
+  catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  EXPECT_TRUE(thrown);
+
+  // the pool is still usable afterwards
+  std::atomic_int count = 0;
+  ParallelFor(pool, 0, 100, 1, [&count](int) { ++count; });
+  EXPECT_EQ(count, 100);
+}
+TEST_END
+
+TEST_BEGIN(ParallelReduceSum)
+{
+  regit::async::WorkStealingThreadPool pool{4};
+  pool.Start();
+
+  const uint64_t sum = ParallelReduce(pool, IndexRange<uint64_t>{0, 1000000, 32}, uint64_t{0},
+    [](uint64_t acc, uint64_t i) { return acc + i; },
+    [](uint64_t left, uint64_t right) { return left + right; });
+  EXPECT_EQ(sum, uint64_t{499999500000});
+
+  const int empty = ParallelReduce(pool, IndexRange<int>{3, 3, 1}, 42,
+    [](int acc, int) { return acc + 1; },
+    [](int left, int right) { return left + right; });
+  EXPECT_EQ(empty, 42);
+}
+TEST_END
+
+TEST_BEGIN(ParallelReduceKeepsOrder)
+{
+  regit::async::GenericThreadPool pool{size_t{3}};
+  pool.Start();
+
+  // concatenation is associative but not commutative
+  std::string expected;
+  for (int i = 0; i != 5000; ++i)
+    expected += static_cast<char>('a' + i % 26);
+
+  const std::string joined = ParallelReduce(pool, IndexRange<int>{0, 5000, 8}, std::string{},
+    [](std::string acc, int i) { acc += static_cast<char>('a' + i % 26); return acc; },
+    [](std::string left, const std::string& right) { return left + right; });
+  EXPECT_TRUE(joined == expected);
+}
+TEST_END
+
+int main(void)
+{
+  AddTestParallelReduceKeepsOrder();
+  AddTestParallelReduceSum();
+  AddTestParallelForRethrows();
+  AddTestNestedParallelFor();
+  AddTestParallelForSignedRange();
+  AddTestParallelForCallerRunsEverythingOnStoppedPool();
+  AddTestParallelForWorkStealing();
+  AddTestParallelForSharedQueue();
+  regit::testing::RunAllTests();
+}
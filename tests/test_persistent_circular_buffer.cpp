@@ -0,0 +1,117 @@
+#include <containers/circular_buffer/include/persistent_circular_buffer.hpp>
+#include <simple_tester.hpp>
+
+#include <string>
+
+#include <sys/wait.h>
+
+namespace
+{
+  struct Tick
+  {
+    long long Timestamp;
+    double Price;
+  };
+
+  std::string JournalPath(const char* name)
+  {
+    std::string path = "/tmp/regit_journal_" + std::to_string(getpid()) + "_" + name;
+    unlink(path.c_str());
+    return path;
+  }
+}
+
+TEST_BEGIN(ReopenKeepsContents)
+{
+  const std::string path = JournalPath("reopen");
+  {
+    regit::containers::PersistentCircularBuffer<Tick> journal{ path, 4 };
+    for (long long i = 0; i != 10; ++i)
+      journal.push(Tick{ i, static_cast<double>(i) / 2 });
+    EXPECT_EQ(journal.size(), 4u);
+    EXPECT_EQ(journal.front().Timestamp, 6);
+  }
+
+  {
+    regit::containers::PersistentCircularBuffer<Tick> journal{ path, 4 };
+    EXPECT_EQ(journal.size(), 4u);
+    EXPECT_EQ(journal.front_sequence(), 6u);
+    EXPECT_EQ(journal.next_sequence(), 10u);
+    EXPECT_EQ(journal.front().Timestamp, 6);
+    EXPECT_EQ(journal.back().Price, 4.5);
+
+    journal.pop_front();
+    journal.emplace(Tick{ 10, 5.0 });
+  }
+
+  regit::containers::PersistentCircularBuffer<Tick> journal{ path, 4 };
+  EXPECT_EQ(journal.size(), 4u);
+  EXPECT_EQ(journal.at(0).Timestamp, 7);
+  EXPECT_EQ(journal[3].Timestamp, 10);
+
+  bool thrown = false;
+  try
+  {
+    regit::containers::PersistentCircularBuffer<Tick> wrongCapacity{ path, 8 };
+  } catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  EXPECT_TRUE(thrown);
+  unlink(path.c_str());
+}
+TEST_END
+
+TEST_BEGIN(RecoversAfterCrash)
+{
+  const std::string path = JournalPath("crash");
+  pid_t child = fork();
+  if (child == 0)
+  {
+    regit::containers::PersistentCircularBuffer<Tick> journal{ path, 16, { regit::containers::JournalSyncPolicy::Mode::Sync, 4 } };
+    for (long long i = 0; i != 11; ++i)
+      journal.push(Tick{ i, 1.0 });
+    // die without running any destructor, the header was last synced after 8 pushes
+    _exit(0);
+  }
+  int status = 0;
+  waitpid(child, &status, 0);
+
+  regit::containers::PersistentCircularBuffer<Tick> journal{ path, 16 };
+  EXPECT_EQ(journal.size(), 11u);
+  EXPECT_EQ(journal.back().Timestamp, 10);
+  unlink(path.c_str());
+}
+TEST_END
+
+TEST_BEGIN(DropsTornRecords)
+{
+  const std::string path = JournalPath("torn");
+  {
+    regit::containers::PersistentCircularBuffer<Tick> journal{ path, 8, { regit::containers::JournalSyncPolicy::Mode::DataSync, 0 } };
+    for (long long i = 0; i != 5; ++i)
+      journal.push(Tick{ i, 2.0 });
+  }
+
+  // tear the newest record (slot 4) behind the journal's back
+  int fd = open(path.c_str(), O_RDWR);
+  const long page = sysconf(_SC_PAGESIZE);
+  const long long garbage = 12345;
+  const off_t offset = page + 4 * static_cast<off_t>(sizeof(long long) * 2 + sizeof(Tick)) + 16;
+  EXPECT_EQ(pwrite(fd, &garbage, sizeof(garbage), offset), static_cast<ssize_t>(sizeof(garbage)));
+  close(fd);
+
+  regit::containers::PersistentCircularBuffer<Tick> journal{ path, 8 };
+  EXPECT_EQ(journal.size(), 4u);
+  EXPECT_EQ(journal.back().Timestamp, 3);
+  unlink(path.c_str());
+}
+TEST_END
+
+int main(void)
+{
+  AddTestDropsTornRecords();
+  AddTestRecoversAfterCrash();
+  AddTestReopenKeepsContents();
+  regit::testing::RunAllTests();
+}
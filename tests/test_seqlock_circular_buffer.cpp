@@ -0,0 +1,114 @@
+#include <containers/circular_buffer/include/seqlock_circular_buffer.hpp>
+#include <simple_tester.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  // every field carries the same value, a torn copy mixes two of them
+  struct Snapshot
+  {
+    long long Fields[8];
+
+    bool consistent() const
+    {
+      for (long long field : Fields)
+        if (field != Fields[0])
+          return false;
+      return true;
+    }
+  };
+
+  Snapshot Make(long long value)
+  {
+    Snapshot snapshot;
+    for (long long& field : snapshot.Fields)
+      field = value;
+    return snapshot;
+  }
+}
+
+TEST_BEGIN(LatestValues)
+{
+  regit::containers::SeqlockCircularBuffer<int> ring(5);
+  EXPECT_EQ(ring.capacity(), 8u);
+  EXPECT_TRUE(ring.empty());
+
+  int value = -1;
+  EXPECT_FALSE(ring.latest(value));
+  for (int i = 0; i != 11; ++i)
+    ring.push(i);
+
+  EXPECT_EQ(ring.size(), 8u);
+  EXPECT_EQ(ring.front_sequence(), 3u);
+  EXPECT_TRUE(ring.latest(value));
+  EXPECT_EQ(value, 10);
+
+  // overwritten and not yet published sequences are refused
+  EXPECT_FALSE(ring.try_read(2, value));
+  EXPECT_FALSE(ring.try_read(11, value));
+  EXPECT_TRUE(ring.try_read(3, value));
+  EXPECT_EQ(value, 3);
+
+  int out[16];
+  EXPECT_EQ(ring.read_latest(out, 4), 4u);
+  EXPECT_EQ(out[0], 7);
+  EXPECT_EQ(out[3], 10);
+  EXPECT_EQ(ring.read_latest(out, 16), 8u);
+  EXPECT_EQ(out[0], 3);
+}
+TEST_END
+
+TEST_BEGIN(ConcurrentReaders)
+{
+  regit::containers::SeqlockCircularBuffer<Snapshot> ring(64);
+  std::atomic<bool> done{ false };
+  std::atomic<int> torn{ 0 }, outOfOrder{ 0 };
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r != 4; ++r)
+    readers.emplace_back([&] {
+      Snapshot batch[16];
+      long long last = -1;
+      while (!done.load(std::memory_order_acquire))
+      {
+        Snapshot snapshot;
+        if (ring.latest(snapshot))
+        {
+          torn += !snapshot.consistent();
+          outOfOrder += snapshot.Fields[0] < last;
+          last = snapshot.Fields[0];
+        }
+
+        size_t count = ring.read_latest(batch, 16);
+        for (size_t i = 0; i != count; ++i)
+        {
+          torn += !batch[i].consistent();
+          outOfOrder += i && batch[i].Fields[0] != batch[i - 1].Fields[0] + 1;
+        }
+      }
+    });
+
+  // the writer never waits for the readers
+  for (long long i = 0; i != 1'000'000; ++i)
+    ring.push(Make(i));
+  done.store(true, std::memory_order_release);
+  for (std::thread& reader : readers)
+    reader.join();
+
+  EXPECT_EQ(torn.load(), 0);
+  EXPECT_EQ(outOfOrder.load(), 0);
+  Snapshot newest;
+  EXPECT_TRUE(ring.latest(newest));
+  EXPECT_EQ(newest.Fields[0], 999'999);
+}
+TEST_END
+
+int main(void)
+{
+  AddTestConcurrentReaders();
+  AddTestLatestValues();
+  regit::testing::RunAllTests();
+}
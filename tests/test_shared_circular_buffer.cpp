@@ -0,0 +1,140 @@
+#include <containers/circular_buffer/include/shared_circular_buffer.hpp>
+#include <simple_tester.hpp>
+
+#include <string>
+#include <thread>
+
+#include <sys/wait.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+  struct Quote
+  {
+    long long Sequence;
+    double Bid, Ask;
+  };
+
+  std::string SegmentName(const char* name)
+  {
+    return "/regit_test_" + std::to_string(getpid()) + "_" + name;
+  }
+}
+
+TEST_BEGIN(ReaderSemantics)
+{
+  regit::containers::SharedCircularBufferWriter<Quote> writer{ SegmentName("semantics"), 4 };
+  for (long long i = 0; i != 3; ++i)
+    writer.push(Quote{ i, 1.0, 1.5 });
+
+  regit::containers::SharedCircularBufferReader<Quote> oldest{ writer.name() };
+  regit::containers::SharedCircularBufferReader<Quote> latest{ writer.name(),
+    regit::containers::SharedCircularBufferReader<Quote>::Start::Latest };
+  EXPECT_EQ(oldest.available(), 3u);
+  EXPECT_TRUE(latest.empty());
+
+  // overwrite the two oldest elements before the first reader gets to them
+  for (long long i = 3; i != 6; ++i)
+    writer.emplace(Quote{ i, 2.0, 2.5 });
+
+  Quote quote{};
+  EXPECT_TRUE(oldest.try_pop(quote));
+  EXPECT_EQ(quote.Sequence, 2);
+  EXPECT_EQ(oldest.lapped(), 2u);
+  EXPECT_TRUE(latest.try_pop(quote));
+  EXPECT_EQ(quote.Sequence, 3);
+
+  while (oldest.try_pop(quote));
+  EXPECT_EQ(quote.Sequence, 5);
+  EXPECT_FALSE(oldest.pop(quote, 5ms));
+}
+TEST_END
+
+TEST_BEGIN(OneWriterPerSegment)
+{
+  regit::containers::SharedCircularBufferWriter<Quote> writer{ SegmentName("exclusive"), 4 };
+  writer.push(Quote{ 7, 1.0, 1.5 });
+
+  int error = 0;
+  try
+  {
+    regit::containers::SharedCircularBufferWriter<Quote> second{ writer.name(), 4 };
+  }
+  catch (const std::system_error& e)
+  {
+    error = e.code().value();
+  }
+  EXPECT_EQ(error, EEXIST);
+
+  // the first writer's segment is left alone
+  regit::containers::SharedCircularBufferReader<Quote> reader{ writer.name() };
+  Quote quote{};
+  EXPECT_TRUE(reader.try_pop(quote));
+  EXPECT_EQ(quote.Sequence, 7);
+}
+TEST_END
+
+TEST_BEGIN(BlockingReader)
+{
+  regit::containers::SharedCircularBufferWriter<Quote> writer{ SegmentName("blocking"), 8 };
+  regit::containers::SharedCircularBufferReader<Quote> reader{ writer.name() };
+
+  std::thread producer{
+    [&writer]
+    {
+      std::this_thread::sleep_for(20ms);
+      writer.push(Quote{ 42, 0.0, 0.0 });
+    }};
+
+  Quote quote{};
+  reader.pop(quote);
+  producer.join();
+  EXPECT_EQ(quote.Sequence, 42);
+}
+TEST_END
+
+TEST_BEGIN(CrossProcess)
+{
+  constexpr long long count = 200'000;
+  regit::containers::SharedCircularBufferWriter<Quote> writer{ SegmentName("process"), 1 << 12 };
+
+  pid_t child = fork();
+  if (child == 0)
+  {
+    regit::containers::SharedCircularBufferReader<Quote> reader{ writer.name() };
+    Quote quote{};
+    long long expected = 0;
+    bool ordered = true;
+    // a lapped reader would skip sequences, so ordering is only checked for what arrives
+    while (expected < count)
+    {
+      reader.pop(quote);
+      ordered = ordered && quote.Sequence >= expected && quote.Ask == quote.Bid + 1;
+      expected = quote.Sequence + 1;
+    }
+    _exit(ordered ? 0 : 1);
+  }
+
+  for (long long i = 0; i != count; ++i)
+  {
+    writer.push(Quote{ i, static_cast<double>(i), static_cast<double>(i) + 1 });
+    // give the reader a chance to keep up so most of the run exercises hand-off
+    if (i % 1024 == 0)
+      std::this_thread::yield();
+  }
+
+  int status = 0;
+  waitpid(child, &status, 0);
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+TEST_END
+
+int main(void)
+{
+  AddTestCrossProcess();
+  AddTestBlockingReader();
+  AddTestOneWriterPerSegment();
+  AddTestReaderSemantics();
+  regit::testing::RunAllTests();
+}
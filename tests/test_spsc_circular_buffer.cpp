@@ -0,0 +1,80 @@
+#include <containers/circular_buffer/include/spsc_circular_buffer.hpp>
+#include <simple_tester.hpp>
+
+#include <string>
+#include <thread>
+
+TEST_BEGIN(Capacity)
+{
+  regit::containers::SpscCircularBuffer<int> cb1(5);
+  regit::containers::SpscCircularBuffer<int> cb2(8);
+
+  EXPECT_EQ(cb1.capacity(), 8u);
+  EXPECT_EQ(cb2.capacity(), 8u);
+  EXPECT_TRUE(cb1.empty());
+}
+TEST_END
+
+TEST_BEGIN(PushPop)
+{
+  regit::containers::SpscCircularBuffer<std::string> cb(4);
+  for (int i = 0; i != 4; ++i)
+    EXPECT_TRUE(cb.try_push(std::to_string(i)));
+  EXPECT_FALSE(cb.try_emplace("full"));
+  EXPECT_EQ(cb.size(), 4u);
+
+  std::string value;
+  EXPECT_TRUE(cb.try_pop(value));
+  EXPECT_EQ(value, "0");
+  EXPECT_EQ(*cb.front(), "1");
+  cb.pop();
+
+  // wraps around the end of the storage
+  EXPECT_TRUE(cb.try_emplace("4"));
+  EXPECT_TRUE(cb.try_emplace("5"));
+  std::string result;
+  while (cb.try_pop(value))
+    result += value;
+
+  EXPECT_EQ(result, "2345");
+  EXPECT_TRUE(cb.front() == nullptr);
+}
+TEST_END
+
+TEST_BEGIN(ProducerConsumer)
+{
+  constexpr long long count = 1'000'000;
+  regit::containers::SpscCircularBuffer<long long> cb(1024);
+
+  std::thread producer{
+    [&cb]
+    {
+      for (long long i = 0; i != count; ++i)
+        while (!cb.try_push(i));
+    }};
+
+  bool ordered = true;
+  long long sum = 0, expected = 0, value = 0;
+  while (expected != count)
+  {
+    if (!cb.try_pop(value))
+      continue;
+    ordered = ordered && value == expected;
+    sum += value;
+    ++expected;
+  }
+  producer.join();
+
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(sum, count * (count - 1) / 2);
+  EXPECT_TRUE(cb.empty());
+}
+TEST_END
+
+int main(void)
+{
+  AddTestProducerConsumer();
+  AddTestPushPop();
+  AddTestCapacity();
+  regit::testing::RunAllTests();
+}
@@ -0,0 +1,112 @@
+#include <containers/circular_buffer/include/static_circular_buffer.hpp>
+#include <simple_tester.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+TEST_BEGIN(Construction)
+{
+  regit::containers::StaticCircularBuffer<int, 4> cb1;
+  regit::containers::StaticCircularBuffer<int, 4> cb2{ 1,2,3,4,5,6 };
+  regit::containers::StaticCircularBuffer<int, 4> cb3{ cb2 };
+  regit::containers::StaticCircularBuffer<int, 4> cb4{ std::move(cb3) };
+
+  EXPECT_TRUE(cb1.empty());
+  EXPECT_EQ(cb2.size(), 4u);
+  EXPECT_EQ(cb2.front(), 3);
+  EXPECT_EQ(cb4.back(), 6);
+  EXPECT_TRUE(cb3.empty());
+  EXPECT_EQ(sizeof(regit::containers::StaticCircularBuffer<int, 4>), sizeof(int) * 4 + sizeof(size_t) * 2);
+}
+TEST_END
+
+TEST_BEGIN(PushEmplacePop)
+{
+  regit::containers::StaticCircularBuffer<std::string, 3> cb;
+  cb.push("A");
+  cb.emplace("B");
+  cb.emplace("C");
+  cb.emplace("D");
+  EXPECT_EQ(cb.front(), "B");
+  EXPECT_EQ(cb.back(), "D");
+
+  cb.pop();
+  EXPECT_EQ(cb.back(), "C");
+  cb.pop_front();
+  EXPECT_EQ(cb.front(), "C");
+  EXPECT_EQ(cb.size(), 1u);
+
+  cb.clear();
+  EXPECT_TRUE(cb.empty());
+}
+TEST_END
+
+TEST_BEGIN(NonPowerOfTwo)
+{
+  regit::containers::StaticCircularBuffer<int, 5> cb;
+  for (int i = 0; i != 12; ++i)
+    cb.push(i);
+
+  std::string order;
+  for (int value : cb)
+    order += std::to_string(value);
+
+  EXPECT_EQ(order, "7891011");
+  EXPECT_EQ(cb[0], 7);
+  EXPECT_EQ(cb.at(4), 11);
+}
+TEST_END
+
+TEST_BEGIN(Subscript)
+{
+  regit::containers::StaticCircularBuffer<int, 8> cb;
+  for (int i = 1; i <= 10; ++i)
+    cb.push(i);
+  for (unsigned i = 1; i != cb.size(); ++i)
+    cb[i] += cb[i - 1];
+
+  bool success = false;
+  try
+  {
+    success = cb.at(8) == 0;           // should invoke a std::out_of_range error
+  } catch (const std::out_of_range&)
+  {
+    success = cb[7] == 52;
+  }
+
+  EXPECT_TRUE(success);
+  EXPECT_EQ(std::accumulate(cb.cbegin(), cb.cend(), 0), 3 + 7 + 12 + 18 + 25 + 33 + 42 + 52);
+}
+TEST_END
+
+TEST_BEGIN(RandomAccessIterators)
+{
+  regit::containers::StaticCircularBuffer<int, 6> cb;
+  for (int value : { 9, 9, 5, 1, 4, 8, 2, 7 })
+    cb.push(value);
+
+  // the ring has wrapped, sorting goes through the logical order
+  std::sort(cb.begin(), cb.end());
+  const int sorted[] = { 1, 2, 4, 5, 7, 8 };
+  EXPECT_TRUE(std::equal(cb.begin(), cb.end(), std::begin(sorted)));
+
+  auto first = cb.begin();
+  auto last = 2 + first;
+  EXPECT_TRUE(last > first);
+  EXPECT_TRUE(first <= last);
+  EXPECT_TRUE(last >= last);
+  EXPECT_EQ(*last, 4);
+  EXPECT_EQ(*std::lower_bound(cb.begin(), cb.end(), 6), 7);
+}
+TEST_END
+
+int main(void)
+{
+  AddTestRandomAccessIterators();
+  AddTestSubscript();
+  AddTestNonPowerOfTwo();
+  AddTestPushEmplacePop();
+  AddTestConstruction();
+  regit::testing::RunAllTests();
+}
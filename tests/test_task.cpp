@@ -0,0 +1,181 @@
+#include <simple_tester.hpp>
+#include <async/include/task.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+using regit::async::Task;
+
+TEST_BEGIN(EmptyTask)
+{
+  Task task;
+  EXPECT_FALSE(static_cast<bool>(task));
+
+  Task fromEmptyFunction{std::function<void()>{}};
+  EXPECT_FALSE(static_cast<bool>(fromEmptyFunction));
+
+  void (*null)() = nullptr;
+  Task fromNullPointer{null};
+  EXPECT_FALSE(static_cast<bool>(fromNullPointer));
+}
+TEST_END
+
+TEST_BEGIN(InlineAndHeapCallables)
+{
+  std::array<char, 48> small{};
+  std::array<char, 256> large{};
+  auto smallLambda = [small] { return small[0]; };
+  auto largeLambda = [large] { return large[0]; };
+  EXPECT_TRUE(Task::is_inline_v<decltype(smallLambda)>);
+  EXPECT_FALSE(Task::is_inline_v<decltype(largeLambda)>);
+
+  int calls = 0;
+  std::array<int, 64> values{};
+  values[63] = 5;
+  Task heap{[&calls, values] { calls += values[63]; }};
+  Task inlined{[&calls] { ++calls; }};
+  heap();
+  inlined();
+  EXPECT_EQ(calls, 6);
+}
+TEST_END
+
+TEST_BEGIN(MoveOnlyCapture)
+{
+  auto value = std::make_unique<int>(7);
+  int seen = 0;
+  Task task{[value = std::move(value), &seen] { seen = *value; }};
+
+  Task moved{std::move(task)};
+  EXPECT_FALSE(static_cast<bool>(task));
+  moved();
+  EXPECT_EQ(seen, 7);
+
+  Task assigned;
+  assigned = std::move(moved);
+  seen = 0;
+  assigned();
+  EXPECT_EQ(seen, 7);
+}
+TEST_END
+
+TEST_BEGIN(DestroysCapture)
+{
+  auto shared = std::make_shared<int>(1);
+  {
+    Task inlined{[shared] { }};
+    std::array<char, 128> padding{};
+    Task heap{[shared, padding] { (void)padding; }};
+    EXPECT_EQ(shared.use_count(), 3);
+    Task moved{std::move(heap)};
+    EXPECT_EQ(shared.use_count(), 3);
+  }
+  EXPECT_EQ(shared.use_count(), 1);
+}
+TEST_END
+
+TEST_BEGIN(SubmissionResult)
+{
+  auto [task, future] = regit::async::detail::MakeSubmission([](int a, int b) { return a * b; }, 6, 7);
+  EXPECT_FALSE(future.Ready());
+
+  std::thread runner{[task = std::move(task)] () mutable { task(); }};
+  EXPECT_EQ(future.Get(), 42);
+  EXPECT_FALSE(future.Valid());
+  runner.join();
+}
+TEST_END
+
+TEST_BEGIN(SubmissionReleasesCapturesBeforeResult)
+{
+  // records when the worker is done destroying it, which takes a while
+  struct SlowCapture
+  {
+    explicit SlowCapture(std::atomic_bool& destroyed) noexcept
+      : m_destroyed{&destroyed}
+    { }
+
+    SlowCapture(SlowCapture&& rhs) noexcept
+      : m_destroyed{std::exchange(rhs.m_destroyed, nullptr)}
+    { }
+
+    ~SlowCapture()
+    {
+      if (!m_destroyed)
+        return;
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      m_destroyed->store(true);
+    }
+
+    std::atomic_bool* m_destroyed;
+  };
+
+  std::atomic_bool destroyed = false;
+  auto [task, future] = regit::async::detail::MakeSubmission(
+    [capture = SlowCapture{destroyed}] { return 1; });
+
+  std::thread runner{[task = std::move(task)] () mutable { task(); }};
+  EXPECT_EQ(future.Get(), 1);
+  EXPECT_TRUE(destroyed.load());
+  runner.join();
+}
+TEST_END
+
+TEST_BEGIN(SubmissionException)
+{
+  auto [task, future] = regit::async::detail::MakeSubmission([] { throw std::runtime_error{"boom"}; });
+  task();
+  EXPECT_TRUE(future.Ready());
+
+  bool thrown = false;
+  try
+  {
+    future.Get();
+  }
+  catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  EXPECT_TRUE(thrown);
+}
+TEST_END
+
+TEST_BEGIN(SubmissionBrokenPromise)
+{
+  auto submission = regit::async::detail::MakeSubmission([] { return 1; });
+  auto future = std::move(submission.second);
+  // the task is dropped without ever running
+  submission.first = Task{};
+
+  EXPECT_TRUE(future.Ready());
+  bool broken = false;
+  try
+  {
+    future.Get();
+  }
+  catch (const std::future_error& error)
+  {
+    broken = error.code() == std::future_errc::broken_promise;
+  }
+  EXPECT_TRUE(broken);
+}
+TEST_END
+
+int main(void)
+{
+  AddTestSubmissionBrokenPromise();
+  AddTestSubmissionException();
+  AddTestSubmissionReleasesCapturesBeforeResult();
+  AddTestSubmissionResult();
+  AddTestDestroysCapture();
+  AddTestMoveOnlyCapture();
+  AddTestInlineAndHeapCallables();
+  AddTestEmptyTask();
+  regit::testing::RunAllTests();
+}
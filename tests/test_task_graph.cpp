@@ -0,0 +1,299 @@
+#include <simple_tester.hpp>
+#include <async/include/task_graph.hpp>
+#include <async/include/thread_pool.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using regit::async::TaskGraph;
+
+namespace
+{
+  // stamps every node with the order it finished in
+  struct Recorder
+  {
+    explicit Recorder(size_t nodes)
+      : m_clock{0}
+      , m_stamps(nodes)
+    { }
+
+    auto Node(size_t node)
+    {
+      return [this, node] { m_stamps[node] = ++m_clock; };
+    }
+
+    bool Before(size_t first, size_t second) const
+    {
+      return m_stamps[first] != 0 && m_stamps[first] < m_stamps[second];
+    }
+
+    std::atomic<int> m_clock;
+    std::vector<std::atomic<int>> m_stamps;
+  };
+}
+
+TEST_BEGIN(DiamondRunsInDependencyOrder)
+{
+  regit::async::WorkStealingThreadPool pool{4};
+  pool.Start();
+
+  Recorder recorder{4};
+  TaskGraph graph;
+  auto a = graph.Emplace(recorder.Node(0));
+  auto b = graph.Emplace(recorder.Node(1), {a});
+  auto c = graph.Emplace(recorder.Node(2), {a});
+  graph.Emplace(recorder.Node(3), {b, c});
+
+  // built once, run many times
+  for (int run = 0; run != 100; ++run)
+  {
+    graph.Run(pool).Wait();
+    EXPECT_TRUE(recorder.Before(0, 1));
+    EXPECT_TRUE(recorder.Before(0, 2));
+    EXPECT_TRUE(recorder.Before(1, 3));
+    EXPECT_TRUE(recorder.Before(2, 3));
+  }
+  EXPECT_EQ(recorder.m_clock.load(), 400);
+}
+TEST_END
+
+TEST_BEGIN(RandomDagRespectsEveryEdge)
+{
+  regit::async::GenericThreadPool pool{size_t{3}};
+  pool.Start();
+
+  const size_t nodes = 200;
+  Recorder recorder{nodes};
+  TaskGraph graph;
+  std::vector<std::pair<size_t, size_t>> edges;
+  std::mt19937 random{42};
+  for (size_t node = 0; node != nodes; ++node)
+  {
+    graph.Emplace(recorder.Node(node));
+    // edges only point forward, so the graph stays acyclic
+    for (int i = 0; node && i != 3; ++i)
+    {
+      size_t predecessor = random() % node;
+      graph.AddDependency(predecessor, node);
+      edges.emplace_back(predecessor, node);
+    }
+  }
+
+  for (int run = 0; run != 10; ++run)
+  {
+    graph.Run(pool).Wait();
+    bool ordered = true;
+    for (auto [first, second] : edges)
+      ordered = ordered && recorder.Before(first, second);
+    EXPECT_TRUE(ordered);
+  }
+  EXPECT_EQ(recorder.m_clock.load(), 2000);
+}
+TEST_END
+
+TEST_BEGIN(Subgraphs)
+{
+  regit::async::WorkStealingThreadPool pool{3};
+  pool.Start();
+
+  Recorder recorder{6};
+  TaskGraph innermost;
+  innermost.Emplace(recorder.Node(2));
+
+  TaskGraph inner;
+  auto first = inner.Emplace(recorder.Node(1));
+  auto nested = inner.EmplaceSubgraph(innermost, {first});
+  inner.Emplace(recorder.Node(3), {nested});
+
+  TaskGraph outer;
+  auto before = outer.Emplace(recorder.Node(0));
+  auto sub = outer.EmplaceSubgraph(inner, {before});
+  outer.Emplace(recorder.Node(4), {sub});
+  TaskGraph empty;
+  outer.EmplaceSubgraph(empty, {sub});
+  outer.Emplace(recorder.Node(5));
+
+  for (int run = 0; run != 20; ++run)
+  {
+    outer.Run(pool).Wait();
+    EXPECT_TRUE(recorder.Before(0, 1));
+    EXPECT_TRUE(recorder.Before(1, 2));
+    EXPECT_TRUE(recorder.Before(2, 3));
+    EXPECT_TRUE(recorder.Before(3, 4));
+    EXPECT_FALSE(inner.Running());
+  }
+  EXPECT_EQ(recorder.m_clock.load(), 120);
+
+  // a subgraph edited after its parent ran is picked up by the parent's next run
+  std::atomic_int count = 0;
+  TaskGraph leaf;
+  leaf.Emplace([&count] { ++count; });
+  TaskGraph parent;
+  parent.EmplaceSubgraph(leaf);
+  parent.Run(pool).Wait();
+  leaf.Emplace([&count] { ++count; });
+  parent.Run(pool).Wait();
+  EXPECT_EQ(count, 3);
+
+  // and a subgraph that turned cyclic fails the parent's run instead of hanging it
+  leaf.AddDependency(0, 1);
+  leaf.AddDependency(1, 0);
+  bool rejected = false;
+  try
+  {
+    parent.Run(pool).Wait();
+  }
+  catch (const std::invalid_argument&)
+  {
+    rejected = true;
+  }
+  EXPECT_TRUE(rejected);
+  EXPECT_FALSE(parent.Running());
+}
+TEST_END
+
+TEST_BEGIN(FailureSkipsSubgraphs)
+{
+  regit::async::WorkStealingThreadPool pool{2};
+  pool.Start();
+
+  std::atomic_int count = 0;
+  TaskGraph sub;
+  sub.Emplace([&count] { ++count; });
+
+  TaskGraph graph;
+  auto thrower = graph.Emplace([] { throw std::runtime_error{"stale price"}; });
+  auto nested = graph.EmplaceSubgraph(sub, {thrower});
+  graph.Emplace([&count] { ++count; }, {nested});
+
+  bool thrown = false;
+  try
+  {
+    graph.Run(pool).Wait();
+  }
+  catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  EXPECT_TRUE(thrown);
+  EXPECT_EQ(count, 0);
+  EXPECT_FALSE(sub.Running());
+}
+TEST_END
+
+TEST_BEGIN(WaitRunsTheGraphOnAnUnstartedPool)
+{
+  regit::async::WorkStealingThreadPool pool{2};
+
+  std::atomic_int count = 0;
+  TaskGraph graph;
+  auto root = graph.Emplace([&count] { ++count; });
+  for (int i = 0; i != 10; ++i)
+    graph.Emplace([&count] { ++count; }, {root});
+
+  auto run = graph.Run(pool);
+  EXPECT_FALSE(run.Done());
+  run.Wait();
+  EXPECT_TRUE(run.Done());
+  EXPECT_EQ(count, 11);
+
+  TaskGraph empty;
+  empty.Run(pool).Wait();
+}
+TEST_END
+
+TEST_BEGIN(ExceptionsSkipTheRestAndRethrow)
+{
+  regit::async::WorkStealingThreadPool pool{2};
+  pool.Start();
+
+  bool fail = true;
+  std::atomic_int after = 0;
+  TaskGraph graph;
+  auto thrower = graph.Emplace(
+    [&fail]
+    {
+      if (fail)
+        throw std::runtime_error{"stale price"};
+    });
+  graph.Emplace([&after] { ++after; }, {thrower});
+
+  bool thrown = false;
+  try
+  {
+    graph.Run(pool).Wait();
+  }
+  catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  EXPECT_TRUE(thrown);
+  EXPECT_EQ(after, 0);
+
+  // the next run starts clean
+  fail = false;
+  graph.Run(pool).Wait();
+  EXPECT_EQ(after, 1);
+}
+TEST_END
+
+TEST_BEGIN(RejectsCyclesAndOverlappingRuns)
+{
+  regit::async::WorkStealingThreadPool pool{2};
+  pool.Start();
+
+  TaskGraph cyclic;
+  auto a = cyclic.Emplace([] { });
+  auto b = cyclic.Emplace([] { }, {a});
+  cyclic.AddDependency(b, a);
+
+  bool rejected = false;
+  try
+  {
+    cyclic.Run(pool);
+  }
+  catch (const std::invalid_argument&)
+  {
+    rejected = true;
+  }
+  EXPECT_TRUE(rejected);
+
+  std::atomic_bool release = false;
+  TaskGraph slow;
+  slow.Emplace(
+    [&release]
+    {
+      while (!release)
+        std::this_thread::yield();
+    });
+
+  auto run = slow.Run(pool);
+  rejected = false;
+  try
+  {
+    slow.Run(pool);
+  }
+  catch (const std::logic_error&)
+  {
+    rejected = true;
+  }
+  release = true;
+  run.Wait();
+  EXPECT_TRUE(rejected);
+}
+TEST_END
+
+int main(void)
+{
+  AddTestRejectsCyclesAndOverlappingRuns();
+  AddTestFailureSkipsSubgraphs();
+  AddTestExceptionsSkipTheRestAndRethrow();
+  AddTestWaitRunsTheGraphOnAnUnstartedPool();
+  AddTestSubgraphs();
+  AddTestRandomDagRespectsEveryEdge();
+  AddTestDiamondRunsInDependencyOrder();
+  regit::testing::RunAllTests();
+}
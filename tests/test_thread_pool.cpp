@@ -3,9 +3,52 @@
 
 #include <atomic>
 #include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 using namespace std::chrono_literals;
 
+namespace
+{
+  // counts the threads that were constructed without any work to run
+  class CountingThread
+  {
+  public:
+    static inline std::atomic_int s_idle = 0;
+    static inline std::atomic_int s_running = 0;
+
+    CountingThread() { ++s_idle; }
+    CountingThread(std::function<void()> work) : m_thread{std::move(work)} { ++s_running; }
+    CountingThread(CountingThread&&) noexcept = default;
+
+    ~CountingThread()
+    {
+      if (m_thread.joinable())
+        m_thread.join();
+    }
+
+  private:
+    std::thread m_thread;
+  };
+
+  template <typename PredicateT>
+  bool WaitFor(PredicateT&& predicate)
+  {
+    auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (!predicate())
+    {
+      if (std::chrono::steady_clock::now() > deadline)
+        return false;
+      std::this_thread::sleep_for(1ms);
+    }
+    return true;
+  }
+}
+
 TEST_BEGIN(OneThread)
 {
   int counter = 0;
@@ -44,8 +87,201 @@ TEST_BEGIN(MultipleThreads)
 }
 TEST_END
 
+TEST_BEGIN(StartCreatesPoolSizeThreads)
+{
+  size_t num_threads = 3;
+  regit::async::GenericThreadPool<CountingThread> thread_pool{num_threads};
+
+  thread_pool.Start();
+  EXPECT_EQ(CountingThread::s_running.load(), 3);
+  EXPECT_EQ(CountingThread::s_idle.load(), 0);
+  thread_pool.Stop();
+}
+TEST_END
+
+TEST_BEGIN(ZeroSizeRunsOneThread)
+{
+  static_assert(std::is_nothrow_constructible_v<regit::async::GenericThreadPool<>, size_t>);
+  static_assert(!std::is_nothrow_constructible_v<regit::async::WorkStealingThreadPool, size_t>);
+
+  std::atomic_int counter = 0;
+  regit::async::WorkStealingThreadPool thread_pool{0};
+
+  thread_pool.Start();
+  thread_pool.Post([&counter] { ++counter; });
+  EXPECT_TRUE(WaitFor([&] { return counter == 1; }));
+  thread_pool.Stop();
+}
+TEST_END
+
+TEST_BEGIN(WorkStealingExternalPosts)
+{
+  std::atomic_int counter = 0;
+
+  regit::async::WorkStealingThreadPool thread_pool{4};
+  const int expected_increments = 10000;
+
+  thread_pool.Start();
+  for (int i = 0; i != expected_increments; ++i)
+    thread_pool.Post([&counter] { ++counter; });
+
+  EXPECT_TRUE(WaitFor([&] { return counter == expected_increments; }));
+  thread_pool.Stop();
+  EXPECT_EQ(counter, expected_increments);
+}
+TEST_END
+
+TEST_BEGIN(WorkStealingNestedPosts)
+{
+  std::atomic_int counter = 0;
+
+  regit::async::WorkStealingThreadPool thread_pool{4};
+  const int roots = 16, children = 1000;
+
+  // children land in the posting worker's deque, the others have to steal them
+  thread_pool.Start();
+  for (int i = 0; i != roots; ++i)
+  {
+    thread_pool.Post(
+      [&]
+      {
+        for (int j = 0; j != children; ++j)
+          thread_pool.Post([&counter] { ++counter; });
+      });
+  }
+
+  EXPECT_TRUE(WaitFor([&] { return counter == roots * children; }));
+  thread_pool.Stop();
+  EXPECT_EQ(counter, roots * children);
+}
+TEST_END
+
+TEST_BEGIN(WorkStealingStopsWithPendingWork)
+{
+  std::atomic_int counter = 0;
+  {
+    regit::async::WorkStealingThreadPool thread_pool{2};
+    thread_pool.Start();
+    thread_pool.Post(
+      [&]
+      {
+        for (int j = 0; j != 1000; ++j)
+          thread_pool.Post([&counter] { std::this_thread::sleep_for(1us); ++counter; });
+      });
+    std::this_thread::sleep_for(1ms);
+  }
+  // whatever did not run is released with the pool
+  EXPECT_TRUE(counter <= 1000);
+}
+TEST_END
+
+TEST_BEGIN(WorkStealingDequeTakesEveryElementOnce)
+{
+  const size_t count = 200000;
+  regit::async::detail::WorkStealingDeque<size_t> deque{2};
+  std::vector<std::atomic_int> seen(count);
+  std::atomic_bool done = false;
+
+  auto thief = [&]
+  {
+    size_t value = 0;
+    while (!done || !deque.Empty())
+      if (deque.Steal(value))
+        ++seen[value];
+  };
+  std::vector<std::thread> thieves;
+  for (int i = 0; i != 3; ++i)
+    thieves.emplace_back(thief);
+
+  // the owner keeps some of its own work, the deque grows from 2 slots under the thieves' feet
+  size_t value = 0;
+  for (size_t i = 0; i != count; ++i)
+  {
+    deque.Push(i);
+    if (i % 3 == 0 && deque.Take(value))
+      ++seen[value];
+  }
+  while (deque.Take(value))
+    ++seen[value];
+  done = true;
+  for (auto& t : thieves)
+    t.join();
+
+  size_t once = 0;
+  for (auto& s : seen)
+    once += s == 1;
+  EXPECT_EQ(once, count);
+}
+TEST_END
+
+TEST_BEGIN(SubmitReturnsResult)
+{
+  regit::async::GenericThreadPool thread_pool{size_t{2}};
+  thread_pool.Start();
+
+  auto sum = thread_pool.Submit([](int a, int b) { return a + b; }, 2, 3);
+  auto text = thread_pool.Submit([](std::unique_ptr<int> value) { return std::to_string(*value); },
+    std::make_unique<int>(42));
+  std::atomic_int counter = 0;
+  auto nothing = thread_pool.Submit([&counter] { ++counter; });
+
+  EXPECT_EQ(sum.Get(), 5);
+  EXPECT_EQ(text.Get(), std::string{"42"});
+  nothing.Get();
+  EXPECT_EQ(counter, 1);
+  thread_pool.Stop();
+}
+TEST_END
+
+TEST_BEGIN(WorkStealingSubmitFromWorker)
+{
+  regit::async::WorkStealingThreadPool thread_pool{3};
+  thread_pool.Start();
+
+  // the inner submission goes to the worker's own deque
+  auto outer = thread_pool.Submit(
+    [&thread_pool]
+    {
+      auto inner = thread_pool.Submit([] { return 20; });
+      return inner.Get() + 1;
+    });
+  EXPECT_EQ(outer.Get(), 21);
+  thread_pool.Stop();
+}
+TEST_END
+
+TEST_BEGIN(SubmitToStoppedPoolBreaksPromise)
+{
+  regit::async::Future<int> future;
+  {
+    regit::async::WorkStealingThreadPool thread_pool{1};
+    future = thread_pool.Submit([] { return 1; });
+  }
+
+  bool broken = false;
+  try
+  {
+    future.Get();
+  }
+  catch (const std::future_error& error)
+  {
+    broken = error.code() == std::future_errc::broken_promise;
+  }
+  EXPECT_TRUE(broken);
+}
+TEST_END
+
 int main(void)
 {
+  AddTestSubmitToStoppedPoolBreaksPromise();
+  AddTestWorkStealingSubmitFromWorker();
+  AddTestSubmitReturnsResult();
+  AddTestWorkStealingDequeTakesEveryElementOnce();
+  AddTestWorkStealingStopsWithPendingWork();
+  AddTestWorkStealingNestedPosts();
+  AddTestWorkStealingExternalPosts();
+  AddTestZeroSizeRunsOneThread();
+  AddTestStartCreatesPoolSizeThreads();
   AddTestOneThread();
   AddTestMultipleThreads();
   regit::testing::RunAllTests();
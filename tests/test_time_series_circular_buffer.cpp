@@ -0,0 +1,89 @@
+#include <containers/circular_buffer/include/time_series_circular_buffer.hpp>
+#include <simple_tester.hpp>
+
+#include <chrono>
+#include <stdexcept>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+  using ring_t = regit::containers::TimeSeriesCircularBuffer<int>;
+
+  ring_t::time_point At(std::chrono::milliseconds offset)
+  {
+    return ring_t::time_point{ } + offset;
+  }
+
+  int Sum(std::pair<regit::containers::Span<const int>, regit::containers::Span<const int>> spans)
+  {
+    int sum = 0;
+    for (auto span : { spans.first, spans.second })
+      for (int value : span)
+        sum += value;
+    return sum;
+  }
+}
+
+TEST_BEGIN(RangeSearch)
+{
+  ring_t ring(8);
+  // ten samples 10 ms apart, the ring wraps and keeps 2..9
+  for (int i = 0; i != 10; ++i)
+    ring.push(i, At(i * 10ms));
+  EXPECT_EQ(ring.size(), 8u);
+  EXPECT_EQ(ring.front(), 2);
+  EXPECT_TRUE(ring.front_time() == At(20ms));
+
+  EXPECT_EQ(Sum(ring.range(At(30ms), At(60ms))), 3 + 4 + 5 + 6);
+  EXPECT_EQ(ring.count(At(25ms), At(55ms)), 3u);
+  EXPECT_EQ(ring.count(At(0ms), At(15ms)), 0u);
+  EXPECT_EQ(ring.count(At(60ms), At(30ms)), 0u);
+  EXPECT_EQ(Sum(ring.last(25ms)), 7 + 8 + 9);
+
+  auto [first, last] = ring.bounds(At(70ms), At(1000ms));
+  EXPECT_EQ(first, 5u);
+  EXPECT_EQ(last, 8u);
+  auto times = ring.time_range(At(70ms), At(1000ms));
+  EXPECT_EQ(times.first.size() + times.second.size(), 3u);
+
+  bool threw = false;
+  try
+  {
+    ring.push(10, At(5ms));
+  }
+  catch (const std::invalid_argument&)
+  {
+    threw = true;
+  }
+  EXPECT_TRUE(threw);
+}
+TEST_END
+
+TEST_BEGIN(AgeEviction)
+{
+  ring_t ring(100, 50ms);
+  for (int i = 0; i != 10; ++i)
+    ring.push(i, At(i * 10ms));
+
+  // anything older than 50 ms relative to the newest push is gone
+  EXPECT_EQ(ring.size(), 6u);
+  EXPECT_EQ(ring.front(), 4);
+  EXPECT_EQ(ring.back(), 9);
+
+  EXPECT_EQ(ring.evict(At(120ms)), 3u);
+  EXPECT_EQ(ring.front(), 7);
+  EXPECT_TRUE(ring.time_at(0) == At(70ms));
+
+  ring.push(42, At(1000ms));
+  EXPECT_EQ(ring.size(), 1u);
+  EXPECT_EQ(ring[0], 42);
+}
+TEST_END
+
+int main(void)
+{
+  AddTestAgeEviction();
+  AddTestRangeSearch();
+  regit::testing::RunAllTests();
+}
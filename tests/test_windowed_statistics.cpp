@@ -0,0 +1,139 @@
+#include <containers/circular_buffer/include/windowed_statistics.hpp>
+#include <simple_tester.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+  bool Near(double lhs, double rhs)
+  {
+    return std::abs(lhs - rhs) <= 1e-6 * std::max(1.0, std::abs(rhs));
+  }
+
+  template <typename T>
+  bool MatchesBruteForce(const regit::containers::WindowedStatistics<T>& stats, const std::deque<T>& window)
+  {
+    double sum = 0.0;
+    for (T value : window)
+      sum += static_cast<double>(value);
+    double mean = sum / static_cast<double>(window.size());
+    double m2 = 0.0;
+    for (T value : window)
+      m2 += (static_cast<double>(value) - mean) * (static_cast<double>(value) - mean);
+
+    return stats.size() == window.size()
+      && Near(stats.sum(), sum)
+      && Near(stats.mean(), mean)
+      && Near(stats.variance(), m2 / static_cast<double>(window.size()))
+      && stats.min() == *std::min_element(window.begin(), window.end())
+      && stats.max() == *std::max_element(window.begin(), window.end());
+  }
+}
+
+TEST_BEGIN(SmallWindow)
+{
+  regit::containers::WindowedStatistics<int> stats(3);
+  stats.push(5);
+  stats.push(1);
+  stats.push(3);
+  EXPECT_EQ(stats.min(), 1);
+  EXPECT_EQ(stats.max(), 5);
+  EXPECT_TRUE(Near(stats.mean(), 3.0));
+
+  stats.push(4);
+  stats.push(2);
+  EXPECT_EQ(stats.min(), 2);
+  EXPECT_EQ(stats.max(), 4);
+  EXPECT_TRUE(Near(stats.sum(), 9.0));
+  EXPECT_TRUE(Near(stats.sample_variance(), 1.0));
+}
+TEST_END
+
+TEST_BEGIN(MatchesBruteForce)
+{
+  std::mt19937 engine{ 42 };
+  std::normal_distribution<double> prices{ 100.0, 5.0 };
+
+  regit::containers::WindowedStatistics<double> stats(64);
+  std::deque<double> window;
+  bool matches = true;
+  for (int i = 0; i != 5000; ++i)
+  {
+    double price = prices(engine);
+    stats.push(price);
+    window.push_back(price);
+    if (window.size() > 64)
+      window.pop_front();
+    matches = matches && MatchesBruteForce(stats, window);
+  }
+
+  EXPECT_TRUE(matches);
+}
+TEST_END
+
+TEST_BEGIN(BulkLoadRecompute)
+{
+  std::vector<double> values(1000);
+  for (size_t i = 0; i != values.size(); ++i)
+    values[i] = static_cast<double>((i * 37) % 101);
+
+  regit::containers::WindowedStatistics<double> stats(100);
+  stats.push(-1.0);
+  stats.push_range(values.begin(), values.begin() + 30);
+  stats.push_range(values.begin() + 30, values.end());
+
+  std::deque<double> window(values.end() - 100, values.end());
+  EXPECT_TRUE(MatchesBruteForce(stats, window));
+
+  // incremental updates keep working after a re-anchor
+  for (double value : { 500.0, -20.0, 7.5 })
+  {
+    stats.push(value);
+    window.push_back(value);
+    window.pop_front();
+  }
+  EXPECT_TRUE(MatchesBruteForce(stats, window));
+  EXPECT_EQ(stats.max(), 500.0);
+  EXPECT_EQ(stats.min(), -20.0);
+}
+TEST_END
+
+TEST_BEGIN(BulkLoadSinglePass)
+{
+  std::istringstream input{ "4 8 15 16 23 42" };
+  regit::containers::WindowedStatistics<double> stats(4);
+  stats.push_range(std::istream_iterator<double>{ input }, std::istream_iterator<double>{ });
+
+  std::deque<double> window{ 15.0, 16.0, 23.0, 42.0 };
+  EXPECT_TRUE(MatchesBruteForce(stats, window));
+  EXPECT_EQ(stats.min(), 15.0);
+  EXPECT_EQ(stats.max(), 42.0);
+
+  // the sequence kept counting, so the extrema still expire on time
+  for (double value : { 1.0, 2.0, 3.0 })
+  {
+    stats.push(value);
+    window.push_back(value);
+    window.pop_front();
+  }
+  EXPECT_TRUE(MatchesBruteForce(stats, window));
+  EXPECT_EQ(stats.max(), 42.0);
+  stats.push(0.0);
+  EXPECT_EQ(stats.max(), 3.0);
+}
+TEST_END
+
+int main(void)
+{
+  AddTestBulkLoadSinglePass();
+  AddTestBulkLoadRecompute();
+  AddTestMatchesBruteForce();
+  AddTestSmallWindow();
+  regit::testing::RunAllTests();
+}